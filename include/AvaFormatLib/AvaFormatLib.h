@@ -7,6 +7,7 @@
 #include "types.h"
 
 #include "util/hashlittle.h"
+#include "util/hashlittle_batch.h"
 #include "util/math.h"
 #include "util/murmur3.h"
 
@@ -15,6 +16,7 @@
 #include "archives/oodle_helper.h"
 #include "archives/resource_bundle.h"
 #include "archives/stream_archive.h"
+#include "archives/virtual_file_system.h"
 
 #include "models/avalanche_model_format.h"
 #include "models/render_block_model.h"
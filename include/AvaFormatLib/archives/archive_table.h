@@ -1,8 +1,13 @@
 #pragma once
 
 #include "../error.h"
+#include "../util/hash_index.h"
+#include "../util/memory_mapped_file.h"
 
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -84,6 +89,21 @@ Result ReadEntryBuffer(const std::vector<uint8_t>& archive_buffer, const TabEntr
                        std::vector<uint8_t>*                  out_buffer,
                        const std::vector<TabCompressedBlock>& compression_blocks = {});
 
+/**
+ * Read an entry file buffer from an ARC file buffer into a caller provided output buffer. The entry is decompressed
+ * straight from the archive memory, without any intermediate copies or allocations.
+ *
+ * @param archive_buffer Pointer to a raw ARC file buffer (e.g. a memory mapped ARC file)
+ * @param archive_buffer_size Size of the ARC file buffer
+ * @param entry Entry to read from the ARC file buffer
+ * @param out_buffer Pointer to the output buffer where the entry file buffer will be written
+ * @param out_buffer_size Size of the output buffer (at least GetEntryDecompressedSize(entry))
+ * @param compression_blocks (Optional) Vector of TabCompressedBlocks (required if entry.m_CompressedBlockIndex != 0)
+ */
+Result ReadEntryBuffer(const uint8_t* archive_buffer, const size_t archive_buffer_size, const TabEntry& entry,
+                       uint8_t* out_buffer, const size_t out_buffer_size,
+                       const std::vector<TabCompressedBlock>& compression_blocks = {});
+
 /**
  * Decompress an entries buffer, similiar to ReadEntryBuffer, but requires the input buffer to only be the entry buffer
  * and not the archive buffer. This means we don't have to keep a whole copy of an archive file in memory.
@@ -97,6 +117,27 @@ Result DecompressEntryBuffer(const std::vector<uint8_t>& buffer, const TabEntry&
                              std::vector<uint8_t>*                  out_buffer,
                              const std::vector<TabCompressedBlock>& compression_blocks = {});
 
+/**
+ * Decompress an entries buffer into a caller provided output buffer, without any intermediate copies or allocations
+ *
+ * @param buffer Pointer to a raw entry file buffer
+ * @param buffer_size Size of the entry file buffer
+ * @param entry Entry whose buffer this belongs to
+ * @param out_buffer Pointer to the output buffer where the decompressed entry file buffer will be written
+ * @param out_buffer_size Size of the output buffer (at least GetEntryDecompressedSize(entry))
+ * @param compression_blocks (Optional) Vector of TabCompressedBlocks (required if entry.m_CompressedBlockIndex != 0)
+ */
+Result DecompressEntryBuffer(const uint8_t* buffer, const size_t buffer_size, const TabEntry& entry,
+                             uint8_t* out_buffer, const size_t out_buffer_size,
+                             const std::vector<TabCompressedBlock>& compression_blocks = {});
+
+/**
+ * Return the size of an entry file buffer once it's decompressed
+ *
+ * @param entry Entry to get the decompressed size of
+ */
+uint32_t GetEntryDecompressedSize(const TabEntry& entry);
+
 /**
  * Return total size required for compressed buffer size
  *
@@ -118,4 +159,331 @@ uint32_t GetEntryRequiredBufferSize(const TabEntry&                        entry
 Result WriteEntry(std::vector<uint8_t>* out_tab_buffer, std::vector<uint8_t>* out_arc_buffer,
                   const std::string& filename, const std::vector<uint8_t>& file_buffer,
                   ECompressLibrary compression = E_COMPRESS_LIBRARY_NONE);
+
+/**
+ * Name hash index over parsed TAB entries. Build it once from Parse output and reuse it for lookups, instead of calling
+ * ReadEntry (which re-parses the TAB buffer and searches linearly) for every entry.
+ */
+class EntryIndex
+{
+  public:
+    EntryIndex() = default;
+    EntryIndex(std::vector<TabEntry> entries) { Build(std::move(entries)); }
+
+    /**
+     * Build the index from parsed TAB entries (if a name hash appears more than once, the first entry is used)
+     *
+     * @param entries Vector of TabEntry's returned from Parse
+     */
+    void Build(std::vector<TabEntry> entries);
+
+    /**
+     * Find an entry from its filename hash
+     *
+     * @param name_hash Filename hash of the entry to find
+     * @return Pointer to the entry, or nullptr if the entry doesn't exist
+     */
+    const TabEntry* Find(const uint32_t name_hash) const
+    {
+        const uint32_t index = m_Index.find(name_hash);
+        return (index != utils::HashIndex::INVALID_VALUE ? &m_Entries[index] : nullptr);
+    }
+
+    /**
+     * Read a single entry from the index
+     *
+     * @param name_hash Filename hash of the entry to read
+     * @param out_entry Pointer to a TabEntry struct where the entry will be written
+     */
+    Result ReadEntry(const uint32_t name_hash, TabEntry* out_entry) const;
+
+    void                         Clear();
+    const std::vector<TabEntry>& GetEntries() const { return m_Entries; }
+
+  private:
+    std::vector<TabEntry> m_Entries;
+    utils::HashIndex      m_Index;
+};
+
+/**
+ * Throughput statistics of a batch read
+ */
+struct BatchStats {
+    uint32_t m_NumWorkers     = 0; // number of threads which extracted entries (including the calling thread)
+    uint32_t m_NumEntries     = 0; // number of entries which were extracted successfully
+    uint32_t m_NumFailed      = 0; // number of entries which were unknown or failed to decompress
+    uint64_t m_BytesRead      = 0; // compressed bytes read from the ARC file
+    uint64_t m_BytesWritten   = 0; // decompressed bytes delivered to the callback
+    double   m_ElapsedSeconds = 0.0;
+
+    // MB/s
+    double GetReadThroughput() const
+    {
+        return m_ElapsedSeconds > 0.0 ? (m_BytesRead / 1048576.0) / m_ElapsedSeconds : 0.0;
+    }
+    double GetWriteThroughput() const
+    {
+        return m_ElapsedSeconds > 0.0 ? (m_BytesWritten / 1048576.0) / m_ElapsedSeconds : 0.0;
+    }
+};
+
+/**
+ * Callback for batch reads, called once for every requested name hash. Callbacks are called from worker threads, and
+ * can run concurrently.
+ *
+ * @param entry Entry which was read (only m_NameHash is valid if the entry doesn't exist)
+ * @param result Result of the read
+ * @param buffer Decompressed entry file buffer (empty if the read failed)
+ */
+using BatchCallback = std::function<void(const TabEntry& entry, Result result, std::vector<uint8_t>&& buffer)>;
+
+/**
+ * Read-only handle to a TAB & ARC file pair. The TAB file is parsed once when the handle is opened, and the ARC file
+ * is memory mapped so entry buffers are served directly from the mapping. Only the pages of entries which are read
+ * become resident, so memory usage does not scale with the archive size.
+ */
+class ArchiveHandle
+{
+  public:
+    ArchiveHandle() = default;
+    ~ArchiveHandle() = default;
+
+    ArchiveHandle(const ArchiveHandle&) = delete;
+    ArchiveHandle& operator=(const ArchiveHandle&) = delete;
+    ArchiveHandle(ArchiveHandle&&)                 = default;
+    ArchiveHandle& operator=(ArchiveHandle&&) = default;
+
+    /**
+     * Open a TAB & ARC file pair
+     *
+     * @param tab_filename Path to the TAB file
+     * @param arc_filename Path to the ARC file
+     */
+    Result Open(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename);
+
+    /**
+     * Close the archive and release the ARC mapping
+     */
+    void Close();
+
+    /**
+     * Find a single entry
+     *
+     * @param name_hash Filename hash of the entry to find
+     * @param out_entry Pointer to a TabEntry struct where the entry will be written
+     */
+    Result ReadEntry(const uint32_t name_hash, TabEntry* out_entry) const;
+
+    /**
+     * Read an entry file buffer from the ARC mapping
+     *
+     * @param entry Entry to read from the ARC file
+     * @param out_buffer Pointer to a byte vector where the entry file buffer will be written
+     */
+    Result ReadEntryBuffer(const TabEntry& entry, std::vector<uint8_t>* out_buffer) const;
+
+    /**
+     * Read an entry file buffer from the ARC mapping into a caller provided output buffer
+     *
+     * @param entry Entry to read from the ARC file
+     * @param out_buffer Pointer to the output buffer where the entry file buffer will be written
+     * @param out_buffer_size Size of the output buffer (at least GetEntryDecompressedSize(entry))
+     */
+    Result ReadEntryBuffer(const TabEntry& entry, uint8_t* out_buffer, const size_t out_buffer_size) const;
+
+    /**
+     * Read an entry file buffer from the ARC mapping by filename hash
+     *
+     * @param name_hash Filename hash of the entry to read
+     * @param out_buffer Pointer to a byte vector where the entry file buffer will be written
+     */
+    Result ReadEntryBuffer(const uint32_t name_hash, std::vector<uint8_t>* out_buffer) const;
+
+    /**
+     * Read many entry file buffers at once. Entries are read in ARC offset order so the archive is accessed
+     * sequentially, and are decompressed across a pool of worker threads.
+     *
+     * @param name_hashes Filename hashes of the entries to read
+     * @param callback Callback which receives every entry file buffer (see BatchCallback)
+     * @param num_workers (Optional) Number of threads to use, including the calling thread (0 will use the shared
+     * thread pool)
+     * @param out_stats (Optional) Pointer to a BatchStats struct where the throughput statistics will be written
+     */
+    Result ReadEntryBuffers(const std::vector<uint32_t>& name_hashes, const BatchCallback& callback,
+                            const uint32_t num_workers = 0, BatchStats* out_stats = nullptr) const;
+
+    bool                                   IsOpen() const { return m_ArcFile.is_open(); }
+    const TabHeader&                       GetHeader() const { return m_Header; }
+    const std::vector<TabEntry>&           GetEntries() const { return m_Index.GetEntries(); }
+    const EntryIndex&                      GetIndex() const { return m_Index; }
+    const std::vector<TabCompressedBlock>& GetCompressionBlocks() const { return m_CompressionBlocks; }
+
+  private:
+    TabHeader                       m_Header;
+    EntryIndex                      m_Index;
+    std::vector<TabCompressedBlock> m_CompressionBlocks;
+    utils::MemoryMappedFile         m_ArcFile;
+};
+
+/**
+ * Builds a TAB & ARC file pair by streaming the ARC data straight to a file. Entries are queued and compressed in
+ * batches across the thread pool, then written in the order they were added so the output is deterministic. Entries
+ * larger than TabHeader::m_UncompressedBlockSize are split into compression blocks.
+ */
+class ArchiveBuilder
+{
+  public:
+    /**
+     * @param header TAB header to write, m_Alignment and m_UncompressedBlockSize control the ARC layout (set
+     * m_UncompressedBlockSize to 0 to disable compression blocks)
+     */
+    ArchiveBuilder(const TabHeader& header = TabHeader{})
+        : m_Header(header)
+    {
+    }
+
+    ArchiveBuilder(const ArchiveBuilder&) = delete;
+    ArchiveBuilder& operator=(const ArchiveBuilder&) = delete;
+
+    /**
+     * Create the ARC file to stream entries to
+     *
+     * @param arc_filename Path of the ARC file to write
+     */
+    Result Open(const std::filesystem::path& arc_filename);
+
+    /**
+     * Queue an entry to be written to the ARC file (the builder is flushed once the queued entries are larger than
+     * the max pending size)
+     *
+     * @param filename String containing the name of the entry to write
+     * @param file_buffer Entry file buffer to write to the ARC file
+     * @param compression (Optional) Compression method to use to compress the entry file buffer
+     */
+    Result AddEntry(const std::string& filename, std::vector<uint8_t> file_buffer,
+                    ECompressLibrary compression = E_COMPRESS_LIBRARY_NONE);
+
+    /**
+     * Queue an entry to be written to the ARC file
+     *
+     * @param name_hash Filename hash of the entry to write
+     * @param file_buffer Entry file buffer to write to the ARC file
+     * @param compression (Optional) Compression method to use to compress the entry file buffer
+     */
+    Result AddEntry(const uint32_t name_hash, std::vector<uint8_t> file_buffer,
+                    ECompressLibrary compression = E_COMPRESS_LIBRARY_NONE);
+
+    /**
+     * Compress and write all queued entries to the ARC file
+     */
+    Result Flush();
+
+    /**
+     * Flush the remaining entries and write the TAB file buffer
+     *
+     * @param out_tab_buffer Pointer to a byte vector where the TAB file buffer will be written
+     */
+    Result Finish(std::vector<uint8_t>* out_tab_buffer);
+
+    /**
+     * Flush the remaining entries and write the TAB file
+     *
+     * @param tab_filename Path of the TAB file to write
+     */
+    Result Finish(const std::filesystem::path& tab_filename);
+
+    void   SetMaxPendingSize(const size_t size) { m_MaxPendingSize = size; }
+    size_t GetMaxPendingSize() const { return m_MaxPendingSize; }
+
+    const std::vector<TabEntry>&           GetEntries() const { return m_Entries; }
+    const std::vector<TabCompressedBlock>& GetCompressionBlocks() const { return m_CompressionBlocks; }
+
+  private:
+    struct PendingEntry {
+        uint32_t             m_NameHash;
+        ECompressLibrary     m_Library;
+        std::vector<uint8_t> m_Buffer;
+    };
+
+    TabHeader                       m_Header;
+    std::ofstream                   m_ArcStream;
+    uint64_t                        m_ArcSize = 0;
+    std::vector<TabEntry>           m_Entries;
+    std::vector<TabCompressedBlock> m_CompressionBlocks;
+    std::vector<PendingEntry>       m_PendingEntries;
+    size_t                          m_PendingSize    = 0;
+    size_t                          m_MaxPendingSize = 0x10000000; // 256MB
+};
+
+/**
+ * Patches entries of an existing TAB & ARC file pair in place. A patched entry overwrites its old ARC slot when the new
+ * buffer fits (the old size aligned to TabHeader::m_Alignment, bounded by the next entry), otherwise it's appended to
+ * the end of the ARC file. Only the TabEntry records of patched entries are rewritten, and new entries are appended to
+ * the end of the TAB file, so the cost of a patch scales with the size of the changed data and not the archive size.
+ * Patched entries never use compression blocks, as adding blocks would move every TabEntry record.
+ */
+class ArchivePatcher
+{
+  public:
+    ArchivePatcher() = default;
+    ~ArchivePatcher() { Close(); }
+
+    ArchivePatcher(const ArchivePatcher&) = delete;
+    ArchivePatcher& operator=(const ArchivePatcher&) = delete;
+
+    /**
+     * Open a TAB & ARC file pair for patching
+     *
+     * @param tab_filename Path to the TAB file
+     * @param arc_filename Path to the ARC file
+     */
+    Result Open(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename);
+
+    /**
+     * Flush and close the TAB & ARC files
+     */
+    void Close();
+
+    /**
+     * Replace an entry file buffer, or add it if the entry doesn't exist
+     *
+     * @param filename String containing the name of the entry to patch
+     * @param file_buffer New entry file buffer
+     * @param compression (Optional) Compression method to use to compress the entry file buffer
+     * @param out_in_place (Optional) Pointer to a bool which is set if the entry was written over its old slot
+     */
+    Result PatchEntry(const std::string& filename, const std::vector<uint8_t>& file_buffer,
+                      ECompressLibrary compression = E_COMPRESS_LIBRARY_NONE, bool* out_in_place = nullptr);
+
+    /**
+     * Replace an entry file buffer, or add it if the entry doesn't exist
+     *
+     * @param name_hash Filename hash of the entry to patch
+     * @param file_buffer New entry file buffer
+     * @param compression (Optional) Compression method to use to compress the entry file buffer
+     * @param out_in_place (Optional) Pointer to a bool which is set if the entry was written over its old slot
+     */
+    Result PatchEntry(const uint32_t name_hash, const std::vector<uint8_t>& file_buffer,
+                      ECompressLibrary compression = E_COMPRESS_LIBRARY_NONE, bool* out_in_place = nullptr);
+
+    bool                         IsOpen() const { return m_TabStream.is_open() && m_ArcStream.is_open(); }
+    const TabHeader&             GetHeader() const { return m_Header; }
+    const std::vector<TabEntry>& GetEntries() const { return m_Entries; }
+
+  private:
+    TabHeader             m_Header;
+    std::vector<TabEntry> m_Entries;
+    utils::HashIndex      m_Index;
+    std::vector<uint32_t> m_SortedOffsets;
+    uint32_t              m_NumCompressionBlocks = 0;
+    std::fstream          m_TabStream;
+    std::fstream          m_ArcStream;
+    uint64_t              m_ArcSize = 0;
+
+    uint64_t GetEntryRecordOffset(const uint32_t index) const
+    {
+        return sizeof(TabHeader) + sizeof(uint32_t) + (sizeof(TabCompressedBlock) * m_NumCompressionBlocks)
+               + (sizeof(TabEntry) * index);
+    }
+};
 }; // namespace ava::ArchiveTable
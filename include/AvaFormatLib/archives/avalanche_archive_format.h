@@ -3,6 +3,8 @@
 #include "../error.h"
 
 #include <cstdint>
+#include <functional>
+#include <istream>
 #include <vector>
 
 namespace ava::AvalancheArchiveFormat
@@ -35,6 +37,32 @@ struct AafChunk {
 static_assert(sizeof(AafHeader) == 0x30, "AafHeader alignment is wrong!");
 static_assert(sizeof(AafChunk) == 0x10, "AafChunk alignment is wrong!");
 
+/**
+ * AAF compression settings, the level, strategy and memory level are passed straight to deflateInit2. The defaults
+ * match the game files, and produce the same output as Compress without options.
+ */
+struct CompressOptions {
+    int32_t  m_Level     = -1; // Z_DEFAULT_COMPRESSION
+    int32_t  m_Strategy  = 0;  // Z_DEFAULT_STRATEGY
+    int32_t  m_MemLevel  = 8;  // DEF_MEM_LEVEL
+    uint32_t m_ChunkSize = AAF_MAX_CHUNK_DATA_SIZE;
+};
+
+// fast iteration builds, smaller chunks also compress across more threads
+static constexpr CompressOptions AAF_COMPRESS_FAST{1, 0, 8, (AAF_MAX_CHUNK_DATA_SIZE / 8)};
+
+// shipping builds, best ratio
+static constexpr CompressOptions AAF_COMPRESS_SHIPPING{9, 0, 9, AAF_MAX_CHUNK_DATA_SIZE};
+
+/**
+ * Chunk index entry, locates a chunk in the AAF buffer and in the decompressed buffer
+ */
+struct ChunkRange {
+    AafChunk m_Chunk;
+    uint64_t m_CompressedOffset   = 0; // offset of the compressed data in the AAF buffer (after the chunk header)
+    uint64_t m_DecompressedOffset = 0; // offset of the chunk data in the decompressed buffer
+};
+
 /**
  * Check if a raw file buffer contains a compressed AAF file buffer
  *
@@ -50,6 +78,15 @@ bool IsCompressed(const std::vector<uint8_t>& buffer);
  */
 Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_buffer);
 
+/**
+ * Compress to an AAF buffer with custom compression settings
+ *
+ * @param buffer Input buffer containing a raw file buffer
+ * @param options Compression settings (the chunk size can't be 0 or more than AAF_MAX_CHUNK_DATA_SIZE)
+ * @param out_buffer Pointer to byte vector where the compressed buffer will be written
+ */
+Result Compress(const std::vector<uint8_t>& buffer, const CompressOptions& options, std::vector<uint8_t>* out_buffer);
+
 /**
  * Decompress an AAF buffer
  *
@@ -57,4 +94,69 @@ Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_bu
  * @param out_buffer Pointer to byte vector where the decompressed buffer will be written
  */
 Result Decompress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_buffer);
+
+/**
+ * Decompress an AAF buffer from memory (e.g. an entry view from another archive)
+ *
+ * @param buffer Pointer to a raw AAF file buffer
+ * @param buffer_size Size of the AAF file buffer
+ * @param out_buffer Pointer to byte vector where the decompressed buffer will be written
+ */
+Result Decompress(const uint8_t* buffer, const size_t buffer_size, std::vector<uint8_t>* out_buffer);
+
+/**
+ * Build the chunk index of an AAF buffer. Only the chunk headers are read, nothing is decompressed.
+ *
+ * @param buffer Pointer to a raw AAF file buffer
+ * @param buffer_size Size of the AAF file buffer
+ * @param out_chunks Pointer to ChunkRange vector where the chunk index will be written
+ * @param out_total_size (Optional) Pointer to a uint64_t where the total decompressed size will be written
+ */
+Result BuildChunkIndex(const uint8_t* buffer, const size_t buffer_size, std::vector<ChunkRange>* out_chunks,
+                       uint64_t* out_total_size = nullptr);
+
+/**
+ * Decompress a range of an AAF buffer. Only the chunks covering the range are decompressed, and only up to the end of
+ * the range, so reading e.g. the header of a huge AAF buffer doesn't inflate the whole file.
+ *
+ * @param buffer Pointer to a raw AAF file buffer
+ * @param buffer_size Size of the AAF file buffer
+ * @param chunks Chunk index of the AAF buffer (see BuildChunkIndex)
+ * @param offset Offset of the range in the decompressed buffer
+ * @param size Size of the range
+ * @param out_buffer Pointer to byte vector where the decompressed range will be written
+ */
+Result DecompressRange(const uint8_t* buffer, const size_t buffer_size, const std::vector<ChunkRange>& chunks,
+                       const uint64_t offset, const size_t size, std::vector<uint8_t>* out_buffer);
+
+/**
+ * Decompress a range of an AAF buffer, building the chunk index on the fly
+ *
+ * @param buffer Pointer to a raw AAF file buffer
+ * @param buffer_size Size of the AAF file buffer
+ * @param offset Offset of the range in the decompressed buffer
+ * @param size Size of the range
+ * @param out_buffer Pointer to byte vector where the decompressed range will be written
+ */
+Result DecompressRange(const uint8_t* buffer, const size_t buffer_size, const uint64_t offset, const size_t size,
+                       std::vector<uint8_t>* out_buffer);
+
+/**
+ * Callback for streaming decompression, called once for every decompressed chunk in order
+ *
+ * @param data Pointer to the decompressed chunk buffer (only valid during the call)
+ * @param size Size of the decompressed chunk buffer
+ * @return E_OK to keep decompressing, any other result stops the decompression and is returned from Decompress
+ */
+using ChunkSink = std::function<Result(const uint8_t* data, const uint32_t size)>;
+
+/**
+ * Decompress an AAF stream chunk by chunk. Only one compressed and one decompressed chunk are held in memory at a time
+ * (see AafHeader::m_RequiredUnpackBufferSize), so the memory usage doesn't depend on the size of the AAF file. The
+ * stream is only read forwards, so it doesn't have to be seekable.
+ *
+ * @param stream Input stream positioned at the start of a raw AAF file buffer
+ * @param sink Callback which receives the decompressed chunks
+ */
+Result Decompress(std::istream& stream, const ChunkSink& sink);
 }; // namespace ava::AvalancheArchiveFormat
@@ -26,7 +26,8 @@ enum CompressionLevel {
 };
 
 enum Compresor {
-    OodleLZCompresor_LZH = 0,
+    OodleLZCompresor_Invalid = -1,
+    OodleLZCompresor_LZH     = 0,
     OodleLZCompresor_LZHLW,
     OodleLZCompresor_LZNIB,
     OodleLZCompresor_None,
@@ -45,23 +46,90 @@ enum Compresor {
 using OodleLZ_Compress_t   = int64_t (*)(Compresor type, const void* input, int64_t input_size, const void* output,
                                        CompressionLevel level, uint32_t*, int64_t, int64_t, int64_t, int64_t);
 using OodleLZ_Decompress_t = int64_t (*)(const void* input, int64_t input_size, const void* output, int64_t output_size,
-                                         int32_t, int64_t, int64_t, void*, void*, void*, void*, void* unk,
-                                         int64_t unk_size, int64_t);
-
-static bool                 we_looded_oodle    = false;
-static void*                oodle_handle       = nullptr;
-static OodleLZ_Compress_t   OodleLZ_Compress   = nullptr;
-static OodleLZ_Decompress_t OodleLZ_Decompress = nullptr;
-
-Result LoadLib(const char* oodle_dll_path);
-Result LoadLib(void* handle);
-void   UnloadLib();
+                                         int32_t, int64_t, int64_t, void*, void*, void*, void*, void* decoder_memory,
+                                         int64_t decoder_memory_size, int64_t);
+using OodleLZDecoder_MemorySizeNeeded_t = int64_t (*)(Compresor type, int64_t output_size);
 
 static int64_t GetCompressedBufferSizeNeeded(int64_t size)
 {
     return (size + 274 * ((size + 0x3FFFF) / 0x40000));
 }
 
+/**
+ * Owns one loaded Oodle library. Compress and Decompress are thread safe. Decompress passes a thread_local decoder
+ * scratch buffer to Oodle (when the DLL exports OodleLZDecoder_MemorySizeNeeded), so Oodle doesn't allocate decoder
+ * memory on every call. The scratch buffer is shared by every codec used on that thread, it's allocated on the first
+ * call and only grows if a codec needs more memory.
+ * Load and Unload must not be called while other threads are using the codec.
+ */
+class Codec
+{
+  public:
+    Codec() = default;
+    ~Codec() { Unload(); }
+
+    Codec(const Codec&) = delete;
+    Codec& operator=(const Codec&) = delete;
+
+    /**
+     * Load the Oodle library from a DLL
+     *
+     * @param oodle_dll_path Path to the Oodle DLL
+     */
+    Result Load(const char* oodle_dll_path);
+
+    /**
+     * Use an already loaded Oodle library (the library will not be freed by the codec)
+     *
+     * @param handle Module handle of the loaded Oodle library
+     */
+    Result Load(void* handle);
+
+    /**
+     * Unload the Oodle library
+     */
+    void Unload();
+
+    bool IsLoaded() const { return m_Handle != nullptr; }
+
+    /**
+     * Compress a buffer
+     *
+     * @param data Input buffer
+     * @param data_size Size of the input buffer
+     * @param out_data Output buffer (at least GetCompressedBufferSizeNeeded(data_size) bytes)
+     * @return Compressed size, or 0 if compression failed
+     */
+    int64_t Compress(const void* data, const int64_t data_size, const void* out_data) const;
+
+    /**
+     * Decompress a buffer using the calling thread's decoder scratch buffer (see above)
+     *
+     * @param data Compressed input buffer
+     * @param data_size Size of the compressed input buffer
+     * @param out_data Output buffer
+     * @param out_data_size Decompressed size
+     * @return Decompressed size, or 0 if decompression failed
+     */
+    int64_t Decompress(const void* data, const int64_t data_size, const void* out_data, int64_t out_data_size) const;
+
+  private:
+    void*                m_Handle            = nullptr;
+    bool                 m_OwnsHandle        = false;
+    OodleLZ_Compress_t   m_Compress          = nullptr;
+    OodleLZ_Decompress_t m_Decompress        = nullptr;
+    int64_t              m_DecoderMemorySize = 0;
+};
+
+/**
+ * Return the codec used by the functions below (and by the archive formats)
+ */
+Codec& GetDefaultCodec();
+
+Result LoadLib(const char* oodle_dll_path);
+Result LoadLib(void* handle);
+void   UnloadLib();
+
 int64_t Compress(const void* data, const int64_t data_size, const void* out_data);
 int64_t Compress(const std::vector<uint8_t>* data, std::vector<uint8_t>* out_data);
 int64_t Decompress(const void* data, const int64_t data_size, const void* out_data, int64_t out_data_size);
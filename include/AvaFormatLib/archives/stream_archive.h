@@ -1,9 +1,13 @@
 #pragma once
 
 #include "../error.h"
+#include "../util/hash_index.h"
 
 #include <cstdint>
+#include <filesystem>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ava::StreamArchive
@@ -18,9 +22,18 @@ struct SarcHeader {
     uint32_t m_Version     = 0;
     uint32_t m_Size        = 0;
 };
+
+struct SarcEntryV3 {
+    uint32_t m_NameOffset;
+    uint32_t m_Offset;
+    uint32_t m_Size;
+    uint32_t m_NameHash;
+    uint32_t m_ExtensionHash;
+};
 #pragma pack(pop)
 
 static_assert(sizeof(SarcHeader) == 0x10, "SarcHeader alignment is wrong!");
+static_assert(sizeof(SarcEntryV3) == 0x14, "SarcEntryV3 alignment is wrong!");
 
 struct ArchiveEntry {
     std::string m_Filename = "";
@@ -29,6 +42,17 @@ struct ArchiveEntry {
     uint32_t    m_Size     = 0;
 };
 
+/**
+ * Archive entry which doesn't own its filename, m_Filename points into the SARC buffer it was parsed from so the
+ * buffer must outlive the entry
+ */
+struct ArchiveEntryView {
+    std::string_view m_Filename;
+    uint32_t         m_NameHash = 0;
+    uint32_t         m_Offset   = 0;
+    uint32_t         m_Size     = 0;
+};
+
 /**
  * Parse a SARC file and extract file entries
  *
@@ -37,6 +61,16 @@ struct ArchiveEntry {
  */
 Result Parse(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* out_entries);
 
+/**
+ * Parse a SARC file and extract file entry views. The buffer is read in place, so no filenames are copied and the
+ * only allocation is the output vector.
+ *
+ * @param buffer Pointer to a raw SARC file buffer
+ * @param buffer_size Size of the SARC file buffer
+ * @param out_entries Pointer to vector of ArchiveEntryView's where the entries will be written
+ */
+Result Parse(const uint8_t* buffer, const size_t buffer_size, std::vector<ArchiveEntryView>* out_entries);
+
 /**
  * Parse a Table of Contents file list, commonly used with the .ee.toc extension
  *
@@ -56,6 +90,18 @@ Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* o
 Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* entries, uint32_t* out_total_added,
                 uint32_t* out_total_patched);
 
+/**
+ * Apply several Table of Contents layers to the current entries vector. Layers are applied in order, so entries in
+ * later layers override the same entries in earlier layers (e.g. base game, then patches in ascending priority).
+ *
+ * @param buffers Pointers to input buffers containing raw TOC file buffers, in priority order (lowest first)
+ * @param entries Pointer to vector of ArchiveEntry's where the entries will be modified/written
+ * @param out_total_added (Optional) Pointer to a uint32_t where a total number of added entrys will be written
+ * @param out_total_patched (Optional) Pointer to a uint32_t where a total number of patched entrys will be written
+ */
+Result ParseTOC(const std::vector<const std::vector<uint8_t>*>& buffers, std::vector<ArchiveEntry>* entries,
+                uint32_t* out_total_added, uint32_t* out_total_patched);
+
 /**
  * Init an empty buffer with a SARC header
  *
@@ -73,6 +119,31 @@ Result InitBuffer(std::vector<uint8_t>* buffer, const uint32_t version = 2);
  */
 Result ReadEntry(const std::vector<uint8_t>& buffer, const ArchiveEntry& entry, std::vector<uint8_t>* out_buffer);
 
+/**
+ * Get a view of the buffer of an Archive Entry without copying it. The view points into the SARC buffer, so nested
+ * formats can be parsed straight from the archive memory.
+ *
+ * @param buffer Pointer to a raw SARC file buffer
+ * @param buffer_size Size of the SARC file buffer
+ * @param entry Entry to read buffer of
+ * @param out_data Pointer to a byte pointer where the address of the entry buffer will be written
+ * @param out_size Pointer to a uint32_t where the size of the entry buffer will be written
+ */
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const ArchiveEntry& entry, const uint8_t** out_data,
+                 uint32_t* out_size);
+
+/**
+ * Get a view of the buffer of an Archive Entry without copying it
+ *
+ * @param buffer Pointer to a raw SARC file buffer
+ * @param buffer_size Size of the SARC file buffer
+ * @param entry Entry view to read buffer of, returned from Parse
+ * @param out_data Pointer to a byte pointer where the address of the entry buffer will be written
+ * @param out_size Pointer to a uint32_t where the size of the entry buffer will be written
+ */
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const ArchiveEntryView& entry,
+                 const uint8_t** out_data, uint32_t* out_size);
+
 /**
  * Read the buffer of an Archive Entry by filename
  *
@@ -85,7 +156,8 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const std::vector<ArchiveEn
                  const std::string& filename, std::vector<uint8_t>* out_buffer);
 
 /**
- * Write a file to a SARC buffer
+ * Write a file to a SARC buffer. The whole archive is rebuilt, so every call costs time proportional to the size of
+ * the archive. Use ArchiveBuilder to write many files at once.
  *
  * @param buffer Input buffer containing a raw SARC file buffer
  * @param entries Vector of current archive entries, returned from Parse
@@ -102,4 +174,145 @@ Result WriteEntry(std::vector<uint8_t>* buffer, std::vector<ArchiveEntry>* entri
  * @param entries Vector of archive entries to write to the TOC
  */
 Result WriteTOC(std::vector<uint8_t>* buffer, const std::vector<ArchiveEntry>& entries);
+
+/**
+ * Name hash index over parsed SARC entries. Build it once from Parse (or ParseTOC) output and reuse it for lookups,
+ * instead of calling ReadEntry with a filename (which searches the entries linearly) for every entry.
+ */
+class EntryIndex
+{
+  public:
+    EntryIndex() = default;
+    EntryIndex(std::vector<ArchiveEntry> entries) { Build(std::move(entries)); }
+
+    /**
+     * Build the index from parsed entries (if a name hash appears more than once, the first entry is used)
+     *
+     * @param entries Vector of ArchiveEntry's returned from Parse
+     */
+    void Build(std::vector<ArchiveEntry> entries);
+
+    /**
+     * Find an entry from its filename hash
+     *
+     * @param name_hash Filename hash of the entry to find
+     * @return Pointer to the entry, or nullptr if the entry doesn't exist
+     */
+    const ArchiveEntry* Find(const uint32_t name_hash) const
+    {
+        const uint32_t index = m_Index.find(name_hash);
+        return (index != utils::HashIndex::INVALID_VALUE ? &m_Entries[index] : nullptr);
+    }
+
+    /**
+     * Find an entry from its filename
+     *
+     * @param filename Name of the entry to find
+     * @return Pointer to the entry, or nullptr if the entry doesn't exist
+     */
+    const ArchiveEntry* Find(const std::string_view filename) const;
+
+    /**
+     * Read the buffer of an Archive Entry by filename hash
+     *
+     * @param buffer Input buffer containing a raw SARC file buffer
+     * @param name_hash Filename hash of the entry to read
+     * @param out_buffer Pointer to char vector where the output entry buffer will be written
+     */
+    Result ReadEntry(const std::vector<uint8_t>& buffer, const uint32_t name_hash,
+                     std::vector<uint8_t>* out_buffer) const;
+
+    /**
+     * Read the buffer of an Archive Entry by filename
+     *
+     * @param buffer Input buffer containing a raw SARC file buffer
+     * @param filename Name of the entry to read
+     * @param out_buffer Pointer to char vector where the output entry buffer will be written
+     */
+    Result ReadEntry(const std::vector<uint8_t>& buffer, const std::string_view filename,
+                     std::vector<uint8_t>* out_buffer) const;
+
+    void                             Clear();
+    const std::vector<ArchiveEntry>& GetEntries() const { return m_Entries; }
+
+  private:
+    std::vector<ArchiveEntry> m_Entries;
+    utils::HashIndex          m_Index;
+};
+
+/**
+ * Builds a SARC file from a list of entries in a single pass. The entry headers are laid out once, then every entry
+ * buffer is written straight after them (aligned), so the cost is linear in the size of the archive. Entries keep the
+ * order they were added in, and adding a filename again replaces the earlier entry.
+ */
+class ArchiveBuilder
+{
+  public:
+    /**
+     * @param version SARC version number (2 or 3)
+     */
+    ArchiveBuilder(const uint32_t version = 2)
+        : m_Version(version)
+    {
+    }
+
+    /**
+     * Add an entry to the archive
+     *
+     * @param filename String containing the name of the entry
+     * @param file_buffer Entry file buffer (can be empty)
+     */
+    Result AddEntry(const std::string& filename, std::vector<uint8_t> file_buffer);
+
+    /**
+     * Add a patched entry to the archive. Patched entries are only listed in the entry headers, their buffer is stored
+     * in a different archive.
+     *
+     * @param filename String containing the name of the entry
+     * @param size Size of the entry file buffer
+     * @param offset (Optional) Data offset written to the entry header, 0 or -1 (TOC only entries)
+     */
+    Result AddPatchedEntry(const std::string& filename, const uint32_t size, const uint32_t offset = 0);
+
+    /**
+     * Write the SARC file to a buffer
+     *
+     * @param out_buffer Pointer to a byte vector where the SARC file buffer will be written
+     */
+    Result Write(std::vector<uint8_t>* out_buffer);
+
+    /**
+     * Write the SARC file to a stream
+     *
+     * @param stream Output stream where the SARC file will be written
+     */
+    Result Write(std::ostream& stream);
+
+    /**
+     * Write the SARC file to disk
+     *
+     * @param filename Path of the SARC file to write
+     */
+    Result Write(const std::filesystem::path& filename);
+
+    /**
+     * Return the archive entries, the entry offsets are valid once the archive has been written
+     */
+    const std::vector<ArchiveEntry>& GetEntries() const { return m_Entries; }
+
+  private:
+    struct EntryBuffer {
+        std::vector<uint8_t> m_Buffer;
+        bool                 m_Patched       = false;
+        uint32_t             m_PatchedOffset = 0;
+    };
+
+    uint32_t                  m_Version = 2;
+    std::vector<ArchiveEntry> m_Entries;
+    std::vector<EntryBuffer>  m_Buffers;
+    utils::HashIndex          m_Index;
+
+    void   InsertEntry(const std::string& filename, const uint32_t size, EntryBuffer&& buffer);
+    Result WriteHeaders(std::vector<uint8_t>* out_buffer, uint64_t* out_total_size);
+};
 }; // namespace ava::StreamArchive
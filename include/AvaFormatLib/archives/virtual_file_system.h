@@ -0,0 +1,232 @@
+#pragma once
+
+#include "../error.h"
+#include "../util/hash_index.h"
+#include "../util/memory_mapped_file.h"
+#include "archive_table.h"
+#include "stream_archive.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ava::VirtualFileSystem
+{
+static constexpr uint32_t INVALID_MOUNT = 0xFFFFFFFF;
+
+/**
+ * Mounts many TAB & ARC file pairs (including legacy ones) into one global name hash index. When more than one
+ * archive contains the same name hash, the archive with the highest priority wins, and if the priorities are equal the
+ * archive which was mounted last wins (so patch archives can simply be mounted after the base game archives).
+ * Lookups are a single hash probe no matter how many archives are mounted.
+ */
+class FileSystem
+{
+  public:
+    FileSystem() = default;
+
+    FileSystem(const FileSystem&) = delete;
+    FileSystem& operator=(const FileSystem&) = delete;
+
+    /**
+     * Mount a TAB & ARC file pair
+     *
+     * @param tab_filename Path to the TAB file
+     * @param arc_filename Path to the ARC file
+     * @param priority (Optional) Override priority of the archive entries
+     * @param out_mount_index (Optional) Pointer to a uint32_t where the index of the mount will be written
+     */
+    Result Mount(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename,
+                 const int32_t priority = 0, uint32_t* out_mount_index = nullptr);
+
+    /**
+     * Mount a legacy TAB & ARC file pair
+     *
+     * @param tab_filename Path to the legacy TAB file
+     * @param arc_filename Path to the ARC file
+     * @param priority (Optional) Override priority of the archive entries
+     * @param out_mount_index (Optional) Pointer to a uint32_t where the index of the mount will be written
+     */
+    Result MountLegacy(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename,
+                       const int32_t priority = 0, uint32_t* out_mount_index = nullptr);
+
+    /**
+     * Unmount all archives
+     */
+    void Clear();
+
+    /**
+     * Find the winning entry of a filename hash. Legacy entries are returned as uncompressed TabEntry's.
+     *
+     * @param name_hash Filename hash of the entry to find
+     * @param out_mount_index (Optional) Pointer to a uint32_t where the index of the mount will be written
+     * @return Pointer to the entry, or nullptr if no mounted archive contains the entry
+     */
+    const ArchiveTable::TabEntry* Find(const uint32_t name_hash, uint32_t* out_mount_index = nullptr) const;
+
+    /**
+     * Read the winning entry of a filename hash
+     *
+     * @param name_hash Filename hash of the entry to read
+     * @param out_entry Pointer to a TabEntry struct where the entry will be written
+     * @param out_mount_index (Optional) Pointer to a uint32_t where the index of the mount will be written
+     */
+    Result ReadEntry(const uint32_t name_hash, ArchiveTable::TabEntry* out_entry,
+                     uint32_t* out_mount_index = nullptr) const;
+
+    /**
+     * Read the winning entry file buffer of a filename hash
+     *
+     * @param name_hash Filename hash of the entry to read
+     * @param out_buffer Pointer to a byte vector where the entry file buffer will be written
+     */
+    Result ReadEntryBuffer(const uint32_t name_hash, std::vector<uint8_t>* out_buffer) const;
+
+    /**
+     * Read the winning entry file buffer of a filename
+     *
+     * @param filename String containing the name of the entry to read
+     * @param out_buffer Pointer to a byte vector where the entry file buffer will be written
+     */
+    Result ReadEntryBuffer(const std::string& filename, std::vector<uint8_t>* out_buffer) const;
+
+    bool Contains(const uint32_t name_hash) const { return m_Index.contains(name_hash); }
+
+    size_t                       GetNumMounts() const { return m_Mounts.size(); }
+    size_t                       GetNumEntries() const { return m_Index.size(); }
+    int32_t                      GetMountPriority(const uint32_t mount_index) const;
+    const std::filesystem::path& GetMountFilename(const uint32_t mount_index) const;
+
+  private:
+    struct MountedArchive {
+        std::filesystem::path               m_Filename;
+        int32_t                             m_Priority = 0;
+        bool                                m_Legacy   = false;
+        ArchiveTable::ArchiveHandle         m_Archive;
+        std::vector<ArchiveTable::TabEntry> m_LegacyEntries;
+        utils::MemoryMappedFile             m_LegacyArcFile;
+
+        const std::vector<ArchiveTable::TabEntry>& GetEntries() const
+        {
+            return m_Legacy ? m_LegacyEntries : m_Archive.GetEntries();
+        }
+    };
+
+    struct EntryLocation {
+        uint32_t m_MountIndex;
+        uint32_t m_EntryIndex;
+    };
+
+    std::vector<MountedArchive> m_Mounts;
+    std::vector<EntryLocation>  m_Locations;
+    utils::HashIndex            m_Index;
+
+    void AddMount(MountedArchive&& mount, uint32_t* out_mount_index);
+};
+
+/**
+ * Buffer of a resolved path. The data points into the owner buffer, which is kept alive for as long as the resolved
+ * buffer exists (even if the resolver has already evicted it from its cache).
+ */
+struct ResolvedBuffer {
+    std::shared_ptr<const std::vector<uint8_t>> m_Owner;
+    const uint8_t*                              m_Data = nullptr;
+    size_t                                      m_Size = 0;
+};
+
+/**
+ * Resolves nested paths through the mounted archives, e.g. "editor/entities/foo.ee/editor/entities/foo.epe" reads
+ * foo.ee from the file system, inflates it if it's AAF compressed, and reads foo.epe from the SARC inside it. Layers
+ * are only read when a path needs them, and every container (SARC) layer is cached with its parsed entries, so
+ * resolving siblings in the same container doesn't read or inflate it again. Containers are evicted in least recently
+ * used order once the total size of the buffers owned by the cache exceeds the memory budget.
+ */
+class PathResolver
+{
+  public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = (256 * 1024 * 1024);
+
+    /**
+     * @param file_system File system to resolve the first layer of paths from, must outlive the resolver
+     * @param memory_budget (Optional) Max size in bytes of the buffers owned by the container cache
+     */
+    explicit PathResolver(const FileSystem& file_system, const size_t memory_budget = DEFAULT_MEMORY_BUDGET)
+        : m_FileSystem(file_system)
+        , m_MemoryBudget(memory_budget)
+    {
+    }
+
+    PathResolver(const PathResolver&) = delete;
+    PathResolver& operator=(const PathResolver&) = delete;
+
+    /**
+     * Resolve a nested path
+     *
+     * @param path Path of the file to resolve, containers are separated from their entry names by a '/'
+     * @param out_buffer Pointer to a ResolvedBuffer where the file buffer will be written
+     */
+    Result Resolve(const std::string_view path, ResolvedBuffer* out_buffer);
+
+    /**
+     * Resolve a nested path into a copy of its buffer
+     *
+     * @param path Path of the file to resolve, containers are separated from their entry names by a '/'
+     * @param out_buffer Pointer to a byte vector where the file buffer will be written
+     */
+    Result Resolve(const std::string_view path, std::vector<uint8_t>* out_buffer);
+
+    /**
+     * Evict every cached container
+     */
+    void ClearCache();
+
+    /**
+     * Set the memory budget of the container cache, evicting containers if needed
+     *
+     * @param memory_budget Max size in bytes of the buffers owned by the container cache
+     */
+    void SetMemoryBudget(const size_t memory_budget);
+
+    size_t   GetMemoryBudget() const;
+    size_t   GetCacheSize() const;
+    size_t   GetNumCachedContainers() const;
+    uint32_t GetCacheHits() const;
+    uint32_t GetCacheMisses() const;
+
+  private:
+    struct Container {
+        std::shared_ptr<const std::vector<uint8_t>>  m_Owner;
+        const uint8_t*                               m_Data = nullptr;
+        size_t                                       m_Size = 0;
+        size_t                                       m_Cost = 0;
+        std::vector<StreamArchive::ArchiveEntryView> m_Entries;
+        utils::HashIndex                             m_Index;
+
+        const StreamArchive::ArchiveEntryView* Find(const uint32_t name_hash) const;
+    };
+
+    using ContainerPtr = std::shared_ptr<const Container>;
+    using LruList      = std::list<std::pair<std::string, ContainerPtr>>;
+
+    const FileSystem&                                  m_FileSystem;
+    size_t                                             m_MemoryBudget = DEFAULT_MEMORY_BUDGET;
+    size_t                                             m_CacheSize    = 0;
+    uint32_t                                           m_CacheHits    = 0;
+    uint32_t                                           m_CacheMisses  = 0;
+    LruList                                            m_Lru;
+    std::unordered_map<std::string, LruList::iterator> m_Cache;
+    mutable std::mutex                                 m_Mutex;
+
+    bool   Contains(const Container* container, const std::string_view name) const;
+    Result ReadLayer(const Container* container, const std::string_view name, ResolvedBuffer* out_buffer) const;
+    Result GetContainer(const Container* parent, const std::string_view path, const std::string_view name,
+                        ContainerPtr* out_container);
+    void   Evict();
+};
+}; // namespace ava::VirtualFileSystem
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "error.h"
+#include "util/hash_index.h"
 
 #include <cstdint>
 #include <map>
@@ -182,17 +183,30 @@ namespace AvalancheDataFormat
     Result ParseHeader(const std::vector<uint8_t>& buffer, AdfHeader* out_header,
                        const char** out_description = nullptr);
 
+    /**
+     * Parse ADF buffer header from memory (e.g. an entry view from a SARC file)
+     *
+     * @param buffer Pointer to a buffer containing the ADF header data
+     * @param buffer_size Size of the buffer
+     * @param out_header Pointer to AdfHeader where the data will be written
+     * @param out_description Pointer to a string where the header description will be written (if available)
+     */
+    Result ParseHeader(const uint8_t* buffer, const size_t buffer_size, AdfHeader* out_header,
+                       const char** out_description = nullptr);
+
     class ADF
     {
       protected:
         std::vector<uint8_t>            m_Buffer;
         AdfHeader*                      m_Header = nullptr;
         std::vector<AdfType*>           m_Types;
+        utils::HashIndex                m_TypeIndex; // type hash -> index into m_Types
         std::vector<AdfType*>           m_InternalTypes;
         std::vector<std::string>        m_Strings;
         std::map<uint32_t, std::string> m_StringHashes;
 
       private:
+        void AddType(AdfType* type);
         void AddBuiltInType(EAdfType type, EAdfScalarType scalar_type, uint32_t size, const char* name,
                             uint16_t flags = 3);
         void AddBuiltInTypes()
@@ -213,9 +227,9 @@ namespace AvalancheDataFormat
         }
         void LoadInlineOffsets(const AdfType* type, char* payload, const uint32_t offset = 0);
 
-        const char* GetString(uint64_t index, const AdfHeader* header, const std::vector<uint8_t>& buffer)
+        const char* GetString(uint64_t index, const AdfHeader* header, const uint8_t* buffer)
         {
-            const char* data = (const char*)buffer.data();
+            const char* data = (const char*)buffer;
 
             const char*    strings = &data[header->m_FirstStringDataOffset + header->m_StringCount];
             const uint8_t* lengths = (const uint8_t*)&data[header->m_FirstStringDataOffset];
@@ -238,9 +252,19 @@ namespace AvalancheDataFormat
       public:
         ADF();
         ADF(const std::vector<uint8_t>& buffer);
+
+        /**
+         * Load an ADF file from memory (e.g. an entry view from a SARC file). Instances are fixed up in place, so the
+         * buffer is copied once into the ADF.
+         *
+         * @param buffer Pointer to a raw ADF file buffer
+         * @param buffer_size Size of the ADF file buffer
+         */
+        ADF(const uint8_t* buffer, const size_t buffer_size);
         virtual ~ADF();
 
         void AddTypes(const std::vector<uint8_t>& buffer);
+        void AddTypes(const uint8_t* buffer, const size_t buffer_size);
 
         /**
          * Find a type from its hash
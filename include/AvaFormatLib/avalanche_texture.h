@@ -74,6 +74,20 @@ static_assert(sizeof(AvtxHeader) == 0x80, "AvtxHeader alignment is wrong!");
 Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry, std::vector<uint8_t>* out_buffer,
                      const std::vector<uint8_t>& source_buffer = {});
 
+/**
+ * Read the best ranked entry from an AVTX file in memory (e.g. an entry view from a SARC file)
+ *
+ * @param buffer Pointer to a raw AVTX file buffer
+ * @param buffer_size Size of the AVTX file buffer
+ * @param out_entry Pointer to TextureEntry struct where the texture information will be written
+ * @param out_buffer Pointer to a byte vector where the texture pixel data will be written
+ * @param source_buffer (Optional) Pointer to a source buffer containing raw texture data
+ * @param source_buffer_size (Optional) Size of the source buffer
+ */
+Result ReadBestEntry(const uint8_t* buffer, const size_t buffer_size, TextureEntry* out_entry,
+                     std::vector<uint8_t>* out_buffer, const uint8_t* source_buffer = nullptr,
+                     const size_t source_buffer_size = 0);
+
 /**
  * Read a specific entry from the AVTX buffer
  *
@@ -87,6 +101,22 @@ Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry
 Result ReadEntry(const std::vector<uint8_t>& buffer, const uint8_t stream_index, TextureEntry* out_entry,
                  std::vector<uint8_t>* out_buffer, const std::vector<uint8_t>& source_buffer = {});
 
+/**
+ * Read a specific entry from an AVTX file in memory (e.g. an entry view from a SARC file)
+ *
+ * @param buffer Pointer to a raw AVTX file buffer
+ * @param buffer_size Size of the AVTX file buffer
+ * @param stream_index Stream index to read from the AVTX buffer (some streams may require source_buffer)
+ * @param out_entry Pointer to TextureEntry struct where the texture information will be written
+ * @param out_buffer Pointer to a byte vector where the texture pixel data will be written
+ * @param source_buffer (Optional) Pointer to a source buffer containing raw texture data (only required if the
+ * AvtxStream.m_Source is set)
+ * @param source_buffer_size (Optional) Size of the source buffer
+ */
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const uint8_t stream_index, TextureEntry* out_entry,
+                 std::vector<uint8_t>* out_buffer, const uint8_t* source_buffer = nullptr,
+                 const size_t source_buffer_size = 0);
+
 /**
  * Read all entries from an AVTX buffer
  *
@@ -101,6 +131,22 @@ Result ReadAllEntries(const std::vector<uint8_t>& buffer, AvtxHeader* out_header
                       std::vector<TextureEntry>* out_entries, std::vector<std::vector<uint8_t>>* out_buffers,
                       const std::vector<uint8_t>& source_buffer = {});
 
+/**
+ * Read all entries from an AVTX file in memory (e.g. an entry view from a SARC file)
+ *
+ * @param buffer Pointer to a raw AVTX file buffer
+ * @param buffer_size Size of the AVTX file buffer
+ * @param out_header Pointer to an AvtxHeader struct to write the header data to
+ * @param out_entries Pointer to an array of TextureEntry structures
+ * @param out_buffers Pointer to an array of byte buffer array where the texture pixel data will be written
+ * @param source_buffer (Optional) Pointer to a source buffer containing raw texture data (only required if the
+ * AvtxStream.m_Source is set)
+ * @param source_buffer_size (Optional) Size of the source buffer
+ */
+Result ReadAllEntries(const uint8_t* buffer, const size_t buffer_size, AvtxHeader* out_header,
+                      std::vector<TextureEntry>* out_entries, std::vector<std::vector<uint8_t>>* out_buffers,
+                      const uint8_t* source_buffer = nullptr, const size_t source_buffer_size = 0);
+
 /**
  * Write a texture entry to the AVTX buffer
  *
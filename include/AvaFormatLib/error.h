@@ -6,6 +6,8 @@ enum Result {
     E_OK,
     E_INVALID_ARGUMENT,
     E_NOT_IMPLEMENTED,
+    E_FAILED_TO_OPEN_FILE,
+    E_FAILED_TO_WRITE_FILE,
 
     // oodle
     E_OODLE_LIBRARY_MISSING,
@@ -18,18 +20,21 @@ enum Result {
     E_TAB_INPUT_REQUIRES_COMPRESSION_BLOCKS,
     E_TAB_COMPRESS_BLOCK_FAILED,
     E_TAB_DECOMPRESS_BLOCK_FAILED,
+    E_TAB_ENTRY_OUT_OF_BOUNDS,
 
     // AAF
     E_AAF_INVALID_MAGIC,
     E_AAF_INVALID_CHUNK_MAGIC,
     E_AAF_COMPRESS_CHUNK_FAILED,
     E_AAF_DECOMPRESS_CHUNK_FAILED,
+    E_AAF_CHUNK_OUT_OF_BOUNDS,
 
     // SARC
     E_SARC_INVALID_MAGIC,
     E_SARC_UNKNOWN_VERSION,
     E_SARC_UNKNOWN_ENTRY,
     E_SARC_PATCHED_ENTRY,
+    E_SARC_ENTRY_OUT_OF_BOUNDS,
 
     // RTPC
     E_RTPC_INVALID_MAGIC,
@@ -55,6 +60,8 @@ static const char* ResultToString(Result result)
         case E_OK: return "E_OK";
         case E_INVALID_ARGUMENT: return "E_INVALID_ARGUMENT";
         case E_NOT_IMPLEMENTED: return "E_NOT_IMPLEMENTED";
+        case E_FAILED_TO_OPEN_FILE: return "E_FAILED_TO_OPEN_FILE";
+        case E_FAILED_TO_WRITE_FILE: return "E_FAILED_TO_WRITE_FILE";
 
         // oodle
         case E_OODLE_LIBRARY_MISSING: return "E_OODLE_LIBRARY_MISSING";
@@ -67,18 +74,21 @@ static const char* ResultToString(Result result)
         case E_TAB_INPUT_REQUIRES_COMPRESSION_BLOCKS: return "E_TAB_INPUT_REQUIRES_COMPRESSION_BLOCKS";
         case E_TAB_COMPRESS_BLOCK_FAILED: return "E_TAB_COMPRESS_BLOCK_FAILED";
         case E_TAB_DECOMPRESS_BLOCK_FAILED: return "E_TAB_DECOMPRESS_BLOCK_FAILED";
+        case E_TAB_ENTRY_OUT_OF_BOUNDS: return "E_TAB_ENTRY_OUT_OF_BOUNDS";
 
         // AAF
         case E_AAF_INVALID_MAGIC: return "E_AAF_INVALID_MAGIC";
         case E_AAF_INVALID_CHUNK_MAGIC: return "E_AAF_INVALID_CHUNK_MAGIC";
         case E_AAF_COMPRESS_CHUNK_FAILED: return "E_AAF_COMPRESS_CHUNK_FAILED";
         case E_AAF_DECOMPRESS_CHUNK_FAILED: return "E_AAF_DECOMPRESS_CHUNK_FAILED";
+        case E_AAF_CHUNK_OUT_OF_BOUNDS: return "E_AAF_CHUNK_OUT_OF_BOUNDS";
 
         // SARC
         case E_SARC_INVALID_MAGIC: return "E_SARC_INVALID_MAGIC";
         case E_SARC_UNKNOWN_VERSION: return "E_SARC_UNKNOWN_VERSION";
         case E_SARC_UNKNOWN_ENTRY: return "E_SARC_UNKNOWN_ENTRY";
         case E_SARC_PATCHED_ENTRY: return "E_SARC_PATCHED_ENTRY";
+        case E_SARC_ENTRY_OUT_OF_BOUNDS: return "E_SARC_ENTRY_OUT_OF_BOUNDS";
 
         // RTPC
         case E_RTPC_INVALID_MAGIC: return "E_RTPC_INVALID_MAGIC";
@@ -123,6 +123,15 @@ struct Container {
  */
 Result Parse(const std::vector<uint8_t>& buffer, Container* out_root_container);
 
+/**
+ * Parse an RTPC file from memory (e.g. an entry view from a SARC file)
+ *
+ * @param buffer Pointer to a raw RTPC file buffer
+ * @param buffer_size Size of the RTPC file buffer
+ * @param out_containers Pointer to a Container of the root node
+ */
+Result Parse(const uint8_t* buffer, const size_t buffer_size, Container* out_root_container);
+
 /**
  * Write an RTPC file
  *
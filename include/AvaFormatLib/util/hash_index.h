@@ -0,0 +1,153 @@
+#pragma once
+
+#include <assert.h>
+#include <cstdint>
+#include <vector>
+
+namespace ava::utils
+{
+/**
+ * Flat open-addressing hash table which maps 32-bit name hashes to 32-bit values (usually an index into a vector of
+ * entries). Lookups never allocate, and the table is kept at most half full so probe sequences stay short.
+ */
+class HashIndex
+{
+  public:
+    static constexpr uint32_t INVALID_VALUE = 0xFFFFFFFF;
+
+    HashIndex() = default;
+    explicit HashIndex(const size_t count) { reserve(count); }
+
+    /**
+     * Make sure the table can hold at least count values without rehashing
+     *
+     * @param count Number of values
+     */
+    void reserve(const size_t count)
+    {
+        uint32_t bits = 4;
+        while ((size_t(1) << bits) < (count * 2)) {
+            ++bits;
+        }
+
+        if (bits > bits_ || slots_.empty()) {
+            rehash(bits);
+        }
+    }
+
+    /**
+     * Insert a value, if the hash already exists the existing value is kept
+     *
+     * @param hash Name hash to index
+     * @param value Value to store (can not be INVALID_VALUE)
+     * @return True if the value was inserted, false if the hash was already indexed
+     */
+    bool insert(const uint32_t hash, const uint32_t value)
+    {
+        assert(value != INVALID_VALUE);
+        grow();
+
+        Slot& slot = probe(hash);
+        if (slot.value != INVALID_VALUE) {
+            return false;
+        }
+
+        slot.hash  = hash;
+        slot.value = value;
+        ++size_;
+        return true;
+    }
+
+    /**
+     * Insert a value, replacing the existing value if the hash already exists
+     *
+     * @param hash Name hash to index
+     * @param value Value to store (can not be INVALID_VALUE)
+     */
+    void insert_or_assign(const uint32_t hash, const uint32_t value)
+    {
+        assert(value != INVALID_VALUE);
+        grow();
+
+        Slot& slot = probe(hash);
+        if (slot.value == INVALID_VALUE) {
+            slot.hash = hash;
+            ++size_;
+        }
+
+        slot.value = value;
+    }
+
+    /**
+     * Find the value of a name hash
+     *
+     * @param hash Name hash to find
+     * @return Value, or INVALID_VALUE if the hash isn't indexed
+     */
+    uint32_t find(const uint32_t hash) const
+    {
+        if (slots_.empty()) {
+            return INVALID_VALUE;
+        }
+
+        return const_cast<HashIndex*>(this)->probe(hash).value;
+    }
+
+    bool   contains(const uint32_t hash) const { return find(hash) != INVALID_VALUE; }
+    size_t size() const { return size_; }
+    bool   empty() const { return size_ == 0; }
+
+    void clear()
+    {
+        slots_.clear();
+        bits_ = 0;
+        size_ = 0;
+    }
+
+  private:
+    struct Slot {
+        uint32_t hash  = 0;
+        uint32_t value = INVALID_VALUE;
+    };
+
+    std::vector<Slot> slots_;
+    uint32_t          bits_ = 0;
+    size_t            size_ = 0;
+
+    // fibonacci hashing, spreads sequential hashes (e.g. type ids) over the whole table
+    size_t home(const uint32_t hash) const { return (uint32_t)(hash * 0x9E3779B9u) >> (32 - bits_); }
+
+    Slot& probe(const uint32_t hash)
+    {
+        const size_t mask = (slots_.size() - 1);
+        for (size_t i = home(hash);; i = ((i + 1) & mask)) {
+            Slot& slot = slots_[i];
+            if (slot.value == INVALID_VALUE || slot.hash == hash) {
+                return slot;
+            }
+        }
+    }
+
+    void grow()
+    {
+        if (slots_.empty()) {
+            rehash(4);
+        } else if (((size_ + 1) * 2) > slots_.size()) {
+            rehash(bits_ + 1);
+        }
+    }
+
+    void rehash(const uint32_t bits)
+    {
+        std::vector<Slot> slots = std::move(slots_);
+        slots_.assign(size_t(1) << bits, Slot{});
+        bits_ = bits;
+
+        for (const Slot& slot : slots) {
+            if (slot.value != INVALID_VALUE) {
+                probe(slot.hash) = slot;
+            }
+        }
+    }
+};
+} // namespace ava::utils
@@ -1,8 +1,11 @@
+#pragma once
+
 #include <cstdint>
 #include <cstring>
 #include <stdint.h>
 #include <stdio.h>
 #include <string>
+#include <string_view>
 #include <time.h>
 #include <windows.h>
 #ifdef linux
@@ -321,6 +324,59 @@ inline uint32_t hashlittle(const char *key)
 {
     return hashlittle(key, strlen(key));
 }
+
+namespace detail
+{
+// little endian 32-bit word of key[offset..offset+4), zero padded past the end of the key
+constexpr uint32_t hashlittle_word(const char *key, const size_t offset, const size_t length)
+{
+    uint32_t word = 0;
+    for (size_t i = 0; i < 4 && (offset + i) < length; ++i) {
+        word |= ((uint32_t)(uint8_t)key[offset + i]) << (i * 8);
+    }
+
+    return word;
+}
+}; // namespace detail
+
+/**
+ * constexpr version of hashlittle, for hashing known names at compile time (e.g. switch case labels). Reads the key one
+ * byte at a time, so prefer hashlittle for hashing strings at runtime.
+ */
+constexpr uint32_t hashlittle_constexpr(const char *key, const size_t length)
+{
+    uint32_t a = 0xdeadbeef + ((uint32_t)length);
+    uint32_t b = a;
+    uint32_t c = a;
+
+    size_t offset = 0;
+    while ((length - offset) > 12) {
+        a += detail::hashlittle_word(key, offset, length);
+        b += detail::hashlittle_word(key, offset + 4, length);
+        c += detail::hashlittle_word(key, offset + 8, length);
+        hash_mix(a, b, c);
+        offset += 12;
+    }
+
+    /* zero length strings require no mixing */
+    if (length == 0) {
+        return c;
+    }
+
+    a += detail::hashlittle_word(key, offset, length);
+    b += detail::hashlittle_word(key, offset + 4, length);
+    c += detail::hashlittle_word(key, offset + 8, length);
+    hash_final(a, b, c);
+    return c;
+}
+
+constexpr uint32_t hashlittle_constexpr(const std::string_view key)
+{
+    return hashlittle_constexpr(key.data(), key.size());
+}
+
+static_assert(hashlittle_constexpr("") == 0xDEADBEEF, "hashlittle_constexpr doesn't match hashlittle!");
+static_assert(hashlittle_constexpr("hello.bin") == 0x36AF870F, "hashlittle_constexpr doesn't match hashlittle!");
 }; // namespace ava
 
 struct basic_hash_little {
@@ -329,15 +385,15 @@ struct basic_hash_little {
         return ava::hashlittle(text.c_str());
     }
 
-    static inline uint32_t hash(const char *const aString)
+    static constexpr uint32_t hash(const char *const aString)
     {
-        return ava::hashlittle(aString);
+        return ava::hashlittle_constexpr(aString, std::char_traits<char>::length(aString));
     };
 };
 
 using hash_little = basic_hash_little;
 
-inline uint32_t operator"" _hash_little(const char *aString, const size_t)
+constexpr uint32_t operator"" _hash_little(const char *aString, const size_t)
 {
     using hash_type = hash_little;
     return hash_type::hash(aString);
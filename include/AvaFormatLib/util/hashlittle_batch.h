@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ava
+{
+/**
+ * Number of strings hashlittle_batch hashes at once (16 with AVX2, 8 with SSE2, 1 without SIMD support)
+ */
+size_t hashlittle_batch_width();
+
+/**
+ * Hash many strings at once. Every SIMD lane runs its own Jenkins lookup3 state, so the results are bit-identical to
+ * calling hashlittle on every string. The AVX2 lanes are only used when the library is built with AVX2 enabled
+ * (/arch:AVX2 or -mavx2), otherwise SSE2 is used on x86 and plain hashlittle everywhere else. Strings are grouped by
+ * their number of 12 byte blocks, strings of 12 bytes or less (and of more than 768 bytes) are hashed one by one.
+ *
+ * @param keys Pointer to the strings to hash
+ * @param count Number of strings
+ * @param out_hashes Pointer to count uint32_t's where the hashes will be written
+ */
+void hashlittle_batch(const std::string_view* keys, const size_t count, uint32_t* out_hashes);
+
+/**
+ * Hash many strings at once, see above
+ *
+ * @param keys Strings to hash
+ * @param out_hashes Pointer to a uint32_t vector where the hashes will be written
+ */
+void hashlittle_batch(const std::vector<std::string>& keys, std::vector<uint32_t>* out_hashes);
+}; // namespace ava
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace ava::utils
+{
+/**
+ * Read-only memory mapping of a whole file. Pages are only faulted in when they are touched, so mapping a large file
+ * does not make it resident in memory.
+ */
+class MemoryMappedFile
+{
+  public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile() { close(); }
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept { *this = std::move(other); }
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    /**
+     * Map a file into memory
+     *
+     * @param filename Path of the file to map
+     */
+    bool open(const std::filesystem::path& filename);
+
+    /**
+     * Unmap the file (if mapped)
+     */
+    void close();
+
+    const uint8_t* data() const { return data_; }
+    size_t         size() const { return size_; }
+    bool           is_open() const { return data_ != nullptr; }
+
+  private:
+    const uint8_t* data_ = nullptr;
+    size_t         size_ = 0;
+#ifdef _WIN32
+    void* file_    = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int file_ = -1;
+#endif
+};
+} // namespace ava::utils
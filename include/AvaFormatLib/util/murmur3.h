@@ -13,6 +13,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string_view>
 
 namespace ava
 {
@@ -42,7 +43,7 @@ __forceinline uint64_t getblock64(const uint64_t *p, int i)
 //-----------------------------------------------------------------------------
 // Finalization mix - force all bits of a hash block to avalanche
 
-__forceinline uint32_t fmix32(uint32_t h)
+__forceinline constexpr uint32_t fmix32(uint32_t h)
 {
     h ^= h >> 16;
     h *= 0x85ebca6b;
@@ -55,7 +56,7 @@ __forceinline uint32_t fmix32(uint32_t h)
 
 //----------
 
-__forceinline uint64_t fmix64(uint64_t k)
+__forceinline constexpr uint64_t fmix64(uint64_t k)
 {
     k ^= k >> 33;
     k *= BIG_CONSTANT(0xff51afd7ed558ccd);
@@ -402,6 +403,114 @@ inline uint64_t HashString64(const char *str)
     return out[0];
 }
 
+//-----------------------------------------------------------------------------
+// constexpr versions, for hashing known names at compile time. They read the key one byte at a time, so prefer the
+// functions above for hashing strings at runtime.
+
+constexpr uint64_t rotl64_constexpr(const uint64_t x, const int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// little endian 64-bit word of key[offset..offset+count)
+constexpr uint64_t getblock64_constexpr(const char *key, const size_t offset, const size_t count)
+{
+    uint64_t block = 0;
+    for (size_t i = 0; i < count; ++i) {
+        block |= ((uint64_t)(uint8_t)key[offset + i]) << (i * 8);
+    }
+
+    return block;
+}
+
+constexpr void MurmurHash3_x64_128_constexpr(const char *key, const int len, const uint32_t seed, uint64_t *out)
+{
+    const int nblocks = len / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+    const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+    //----------
+    // body
+
+    for (int i = 0; i < nblocks; i++) {
+        uint64_t k1 = getblock64_constexpr(key, i * 16, 8);
+        uint64_t k2 = getblock64_constexpr(key, i * 16 + 8, 8);
+
+        k1 *= c1;
+        k1 = rotl64_constexpr(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+
+        h1 = rotl64_constexpr(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = rotl64_constexpr(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+
+        h2 = rotl64_constexpr(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    //----------
+    // tail
+
+    const size_t tail   = nblocks * 16;
+    const size_t remain = len & 15;
+
+    if (remain > 8) {
+        uint64_t k2 = getblock64_constexpr(key, tail + 8, remain - 8);
+        k2 *= c2;
+        k2 = rotl64_constexpr(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+    }
+
+    if (remain > 0) {
+        uint64_t k1 = getblock64_constexpr(key, tail, remain > 8 ? 8 : remain);
+        k1 *= c1;
+        k1 = rotl64_constexpr(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    }
+
+    //----------
+    // finalization
+
+    h1 ^= len;
+    h2 ^= len;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    out[0] = h1;
+    out[1] = h2;
+}
+
+constexpr uint64_t HashString64_constexpr(const std::string_view str)
+{
+    uint64_t out[2] = {};
+    MurmurHash3_x64_128_constexpr(str.data(), static_cast<int>(str.size()), 0, out);
+    return out[0];
+}
+
+static_assert(HashString64_constexpr("") == 0, "HashString64_constexpr doesn't match HashString64!");
+static_assert(HashString64_constexpr("hello.bin") == 0xA2C786A7114912DB,
+              "HashString64_constexpr doesn't match HashString64!");
+
 //-----------------------------------------------------------------------------
 
 }; // namespace ava
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ava::utils
+{
+/**
+ * Fixed size pool of worker threads
+ */
+class ThreadPool
+{
+  public:
+    /**
+     * @param num_threads Number of worker threads (0 will use the number of hardware threads)
+     */
+    explicit ThreadPool(size_t num_threads = 0)
+    {
+        if (num_threads == 0) {
+            num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        threads_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this] { worker(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+
+        cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a task to run on the pool
+     *
+     * @param fn Task to run
+     * @return Future which holds the result of the task
+     */
+    template <typename F> auto enqueue(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+
+        auto task   = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        auto result = task->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back([task] { (*task)(); });
+        }
+
+        cv_.notify_one();
+        return result;
+    }
+
+    size_t size() const { return threads_.size(); }
+
+    /**
+     * Process-wide pool sized to the number of hardware threads, used by the parallel code paths in the library
+     */
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+  private:
+    std::vector<std::thread>          threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex                        mutex_;
+    std::condition_variable           cv_;
+    bool                              stop_ = false;
+
+    void worker()
+    {
+        while (true) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task();
+        }
+    }
+};
+
+/**
+ * Run fn(index) for every index in [0, count) across a thread pool and wait for all of them to finish.
+ * Indices are handed out in ascending order, and the calling thread works on them too, so this is safe to call from
+ * inside another pool task.
+ * If fn throws, the remaining indices still run and the first exception is rethrown on the calling thread once every
+ * index is finished.
+ *
+ * @param pool Thread pool to run on
+ * @param count Number of indices
+ * @param fn Function to call for every index
+ */
+template <typename F> void parallel_for(ThreadPool& pool, const size_t count, F&& fn)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1 || pool.size() <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+
+        return;
+    }
+
+    struct State {
+        std::function<void(size_t)> fn;
+        size_t                      count;
+        std::atomic<size_t>         next{0};
+        std::atomic<size_t>         done{0};
+        std::mutex                  mutex;
+        std::condition_variable     cv;
+        std::exception_ptr          exception;
+    };
+
+    // helpers may start after the work is finished, so they keep the state alive themselves
+    auto state   = std::make_shared<State>();
+    state->fn    = std::forward<F>(fn);
+    state->count = count;
+
+    const auto run = [](State& state) {
+        size_t index;
+        while ((index = state.next.fetch_add(1)) < state.count) {
+            try {
+                state.fn(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.exception) {
+                    state.exception = std::current_exception();
+                }
+            }
+
+            if ((state.done.fetch_add(1) + 1) == state.count) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.cv.notify_all();
+            }
+        }
+    };
+
+    const size_t num_helpers = std::min(pool.size(), count - 1);
+    for (size_t i = 0; i < num_helpers; ++i) {
+        pool.enqueue([state, run] { run(*state); });
+    }
+
+    run(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == state->count; });
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+} // namespace ava::utils
@@ -7,104 +7,218 @@
 namespace ava::zlib
 {
 /**
- * Reimplementation of zlib compress() function, with MAX_WBITS corrected, so we don't have to override DEF_WBITS.
- * Compresses to raw DEFLATE so we don't have to manually remove GZIP/ZLIB header/checksum.
+ * Reusable deflate context. The z_stream state is allocated once and reset between buffers with deflateReset, which is
+ * much cheaper than deflateInit2/deflateEnd for every buffer when compressing lots of small buffers.
+ * A Deflater must only be used by one thread at a time.
  */
-int32_t Compress(const uint8_t* src, uint32_t src_len, uint8_t* dest, uint32_t* dest_len)
+class Deflater
 {
-    z_stream       stream;
-    int32_t        err;
-    const uint32_t max = -1;
-    uint32_t       left;
-
-    left      = *dest_len;
-    *dest_len = 0;
-
-    stream.zalloc = (alloc_func)0;
-    stream.zfree  = (free_func)0;
-    stream.opaque = (voidpf)0;
-
-    err =
-        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15 /*-MAX_WBITS*/, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
-    if (err != Z_OK)
-        return err;
-
-    stream.next_out  = dest;
-    stream.avail_out = 0;
-    stream.next_in   = (z_const Bytef*)src;
-    stream.avail_in  = 0;
-
-    do {
-        if (stream.avail_out == 0) {
-            stream.avail_out = left > (uLong)max ? max : (uInt)left;
-            left -= stream.avail_out;
+  public:
+    /**
+     * @param level Compression level (Z_DEFAULT_COMPRESSION, or 0-9)
+     * @param window_bits Window bits (negative for raw DEFLATE, positive for a zlib header/checksum)
+     * @param mem_level Memory level (1-9)
+     * @param strategy Compression strategy (Z_DEFAULT_STRATEGY, Z_FILTERED, ...)
+     */
+    Deflater(int32_t level = Z_DEFAULT_COMPRESSION, int32_t window_bits = -MAX_WBITS,
+             int32_t mem_level = DEF_MEM_LEVEL, int32_t strategy = Z_DEFAULT_STRATEGY)
+    {
+        m_Stream.zalloc = (alloc_func)0;
+        m_Stream.zfree  = (free_func)0;
+        m_Stream.opaque = (voidpf)0;
+        m_InitResult    = deflateInit2(&m_Stream, level, Z_DEFLATED, window_bits, mem_level, strategy);
+    }
+
+    ~Deflater()
+    {
+        if (m_InitResult == Z_OK) {
+            deflateEnd(&m_Stream);
         }
-        if (stream.avail_in == 0) {
-            stream.avail_in = src_len > (uLong)max ? max : (uInt)src_len;
-            src_len -= stream.avail_in;
+    }
+
+    Deflater(const Deflater&) = delete;
+    Deflater& operator=(const Deflater&) = delete;
+
+    /**
+     * Return the maximum compressed size of a buffer
+     *
+     * @param src_len Size of the uncompressed buffer
+     */
+    uint32_t Bound(uint32_t src_len)
+    {
+        return static_cast<uint32_t>(m_InitResult == Z_OK ? deflateBound(&m_Stream, src_len) : compressBound(src_len));
+    }
+
+    /**
+     * Compress a whole buffer
+     *
+     * @param src Uncompressed buffer
+     * @param src_len Size of the uncompressed buffer
+     * @param dest Output buffer
+     * @param dest_len Size of the output buffer (at least Bound(src_len)), the compressed size is written back
+     */
+    int32_t Compress(const uint8_t* src, uint32_t src_len, uint8_t* dest, uint32_t* dest_len)
+    {
+        if (m_InitResult != Z_OK) {
+            return m_InitResult;
         }
-        err = deflate(&stream, src_len ? Z_NO_FLUSH : Z_FINISH);
-    } while (err == Z_OK);
 
-    *dest_len = stream.total_out;
-    deflateEnd(&stream);
-    return err == Z_STREAM_END ? Z_OK : err;
-}
+        if (m_Used) {
+            deflateReset(&m_Stream);
+        }
+
+        m_Used = true;
+
+        m_Stream.next_in   = (z_const Bytef*)src;
+        m_Stream.avail_in  = src_len;
+        m_Stream.next_out  = dest;
+        m_Stream.avail_out = *dest_len;
+
+        const int32_t err = deflate(&m_Stream, Z_FINISH);
+        *dest_len         = static_cast<uint32_t>(m_Stream.total_out);
+        return err == Z_STREAM_END ? Z_OK : (err == Z_OK ? Z_BUF_ERROR : err);
+    }
+
+  private:
+    z_stream m_Stream;
+    int32_t  m_InitResult = Z_OK;
+    bool     m_Used       = false;
+};
 
 /**
- * Reimplementation of zlib uncompress() function, with MAX_WBITS corrected, so we don't have to override DEF_WBITS.
+ * Reusable inflate context. The z_stream state and window are allocated once and reset between buffers with
+ * inflateReset. An Inflater must only be used by one thread at a time.
  */
-int32_t Decompress(const uint8_t* src, uint32_t* src_len, uint8_t* dest, uint32_t* dest_len)
+class Inflater
 {
-    z_stream   stream;
-    int32_t    err;
-    const uInt max = (uInt)-1;
-    uint32_t   len, left;
-    uint8_t    buf[1]; /* for detection of incomplete stream when *destLen == 0 */
-
-    len = *src_len;
-    if (*dest_len) {
-        left      = *dest_len;
-        *dest_len = 0;
-    } else {
-        left = 1;
-        dest = buf;
+  public:
+    /**
+     * @param window_bits Window bits (negative for raw DEFLATE, positive for a zlib header/checksum)
+     */
+    Inflater(int32_t window_bits = -MAX_WBITS)
+    {
+        m_Stream.next_in  = Z_NULL;
+        m_Stream.avail_in = 0;
+        m_Stream.zalloc   = (alloc_func)0;
+        m_Stream.zfree    = (free_func)0;
+        m_Stream.opaque   = (voidpf)0;
+        m_InitResult      = inflateInit2(&m_Stream, window_bits);
     }
 
-    stream.next_in  = (z_const Bytef*)src;
-    stream.avail_in = 0;
-    stream.zalloc   = (alloc_func)0;
-    stream.zfree    = (free_func)0;
-    stream.opaque   = (voidpf)0;
+    ~Inflater()
+    {
+        if (m_InitResult == Z_OK) {
+            inflateEnd(&m_Stream);
+        }
+    }
+
+    Inflater(const Inflater&) = delete;
+    Inflater& operator=(const Inflater&) = delete;
+
+    /**
+     * Decompress a whole buffer
+     *
+     * @param src Compressed buffer
+     * @param src_len Size of the compressed buffer, the amount of consumed input is written back
+     * @param dest Output buffer
+     * @param dest_len Size of the output buffer, the decompressed size is written back
+     */
+    int32_t Decompress(const uint8_t* src, uint32_t* src_len, uint8_t* dest, uint32_t* dest_len)
+    {
+        if (m_InitResult != Z_OK) {
+            return m_InitResult;
+        }
+
+        if (m_Used) {
+            inflateReset(&m_Stream);
+        }
+
+        m_Used = true;
 
-    err = inflateInit2(&stream, -15 /*-MAX_WBITS*/);
-    if (err != Z_OK)
-        return err;
+        m_Stream.next_in   = (z_const Bytef*)src;
+        m_Stream.avail_in  = *src_len;
+        m_Stream.next_out  = dest;
+        m_Stream.avail_out = *dest_len;
 
-    stream.next_out  = dest;
-    stream.avail_out = 0;
+        const int32_t err = inflate(&m_Stream, Z_FINISH);
+        *src_len -= m_Stream.avail_in;
+        *dest_len = static_cast<uint32_t>(m_Stream.total_out);
+
+        return err == Z_STREAM_END ? Z_OK : (err == Z_NEED_DICT || err == Z_BUF_ERROR) ? Z_DATA_ERROR : err;
+    }
 
-    do {
-        if (stream.avail_out == 0) {
-            stream.avail_out = left > (uLong)max ? max : (uInt)left;
-            left -= stream.avail_out;
+    /**
+     * Decompress only the start of a buffer, inflating stops as soon as the output buffer is full
+     *
+     * @param src Compressed buffer
+     * @param src_len Size of the compressed buffer
+     * @param dest Output buffer
+     * @param dest_len Size of the output buffer, which must be filled completely
+     */
+    int32_t DecompressPrefix(const uint8_t* src, uint32_t src_len, uint8_t* dest, uint32_t dest_len)
+    {
+        if (m_InitResult != Z_OK) {
+            return m_InitResult;
         }
-        if (stream.avail_in == 0) {
-            stream.avail_in = len > (uLong)max ? max : (uInt)len;
-            len -= stream.avail_in;
+
+        if (m_Used) {
+            inflateReset(&m_Stream);
+        }
+
+        m_Used = true;
+
+        m_Stream.next_in   = (z_const Bytef*)src;
+        m_Stream.avail_in  = src_len;
+        m_Stream.next_out  = dest;
+        m_Stream.avail_out = dest_len;
+
+        const int32_t err = inflate(&m_Stream, Z_SYNC_FLUSH);
+        if (err != Z_OK && err != Z_STREAM_END) {
+            return err == Z_NEED_DICT ? Z_DATA_ERROR : err;
         }
-        err = inflate(&stream, Z_NO_FLUSH);
-    } while (err == Z_OK);
-
-    *src_len -= len + stream.avail_in;
-    if (dest != buf)
-        *dest_len = stream.total_out;
-    else if (stream.total_out && err == Z_BUF_ERROR)
-        left = 1;
-
-    inflateEnd(&stream);
-    return err == Z_STREAM_END
-               ? Z_OK
-               : err == Z_NEED_DICT ? Z_DATA_ERROR : err == Z_BUF_ERROR && left + stream.avail_out ? Z_DATA_ERROR : err;
-}
+
+        return m_Stream.total_out == dest_len ? Z_OK : Z_DATA_ERROR;
+    }
+
+  private:
+    z_stream m_Stream;
+    int32_t  m_InitResult = Z_OK;
+    bool     m_Used       = false;
+};
+
+/**
+ * Get the deflate context of the calling thread. Contexts are created on first use and live until the thread exits, so
+ * compressing many small buffers doesn't pay for deflateInit2/deflateEnd every time.
+ *
+ * @param window_bits Window bits, -MAX_WBITS for raw DEFLATE or MAX_WBITS for a zlib header/checksum
+ */
+Deflater& GetThreadDeflater(const int32_t window_bits = -MAX_WBITS);
+
+/**
+ * Get the inflate context of the calling thread, see GetThreadDeflater
+ *
+ * @param window_bits Window bits, -MAX_WBITS for raw DEFLATE or MAX_WBITS for a zlib header/checksum
+ */
+Inflater& GetThreadInflater(const int32_t window_bits = -MAX_WBITS);
+
+/**
+ * Compress to raw DEFLATE (so we don't have to manually remove the GZIP/ZLIB header/checksum) with the default
+ * settings, using the deflate context of the calling thread
+ *
+ * @param src Uncompressed buffer
+ * @param src_len Size of the uncompressed buffer
+ * @param dest Output buffer
+ * @param dest_len Size of the output buffer, the compressed size is written back
+ */
+int32_t Compress(const uint8_t* src, uint32_t src_len, uint8_t* dest, uint32_t* dest_len);
+
+/**
+ * Decompress raw DEFLATE, using the inflate context of the calling thread
+ *
+ * @param src Compressed buffer
+ * @param src_len Size of the compressed buffer, the amount of consumed input is written back
+ * @param dest Output buffer
+ * @param dest_len Size of the output buffer, the decompressed size is written back
+ */
+int32_t Decompress(const uint8_t* src, uint32_t* src_len, uint8_t* dest, uint32_t* dest_len);
 }; // namespace ava::zlib
@@ -4,9 +4,16 @@
 #include <util/byte_array_buffer.h>
 #include <util/byte_vector_stream.h>
 #include <util/hashlittle.h>
+#include <util/math.h>
+#include <util/thread_pool.h>
+#include <util/zlib.h>
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <numeric>
 
 namespace ava::ArchiveTable
 {
@@ -65,6 +72,83 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const uint32_t name_hash, T
     return E_OK;
 }
 
+static bool DecompressBlock(const ECompressLibrary library, const uint8_t* data, const uint32_t size,
+                            uint8_t* out_data, const uint32_t out_size)
+{
+    switch (library) {
+        case E_COMPRESS_LIBRARY_ZLIB: {
+            zlib::Inflater& inflater = zlib::GetThreadInflater(MAX_WBITS);
+
+            uint32_t      compressed_size   = size;
+            uint32_t      decompressed_size = out_size;
+            const int32_t result            = inflater.Decompress(data, &compressed_size, out_data, &decompressed_size);
+            return (result == Z_OK && decompressed_size == out_size);
+        }
+
+        case E_COMPRESS_LIBRARY_OODLE: {
+            return (ava::Oodle::Decompress(data, size, out_data, out_size) == out_size);
+        }
+
+        // uncompressed entries are never split into blocks
+        case E_COMPRESS_LIBRARY_NONE: {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+static Result CompressBlock(const ECompressLibrary library, const uint8_t* data, const size_t size,
+                            std::vector<uint8_t>* out_buffer)
+{
+    switch (library) {
+        case E_COMPRESS_LIBRARY_ZLIB: {
+            zlib::Deflater& deflater = zlib::GetThreadDeflater(MAX_WBITS);
+
+            uint32_t compressed_size = deflater.Bound(static_cast<uint32_t>(size));
+            out_buffer->resize(compressed_size);
+
+            const int32_t result =
+                deflater.Compress(data, static_cast<uint32_t>(size), out_buffer->data(), &compressed_size);
+            if (result != Z_OK) {
+                return E_TAB_COMPRESS_BLOCK_FAILED;
+            }
+
+            out_buffer->resize(compressed_size);
+            return E_OK;
+        }
+
+        case E_COMPRESS_LIBRARY_OODLE: {
+            out_buffer->resize(ava::Oodle::GetCompressedBufferSizeNeeded(size));
+
+            const int64_t compressed_size = ava::Oodle::Compress(data, size, out_buffer->data());
+            if (compressed_size <= 0) {
+                return E_TAB_COMPRESS_BLOCK_FAILED;
+            }
+
+            out_buffer->resize(compressed_size);
+            return E_OK;
+        }
+
+        // uncompressed entries are never split into blocks
+        case E_COMPRESS_LIBRARY_NONE: {
+            return E_INVALID_ARGUMENT;
+        }
+    }
+
+    return E_INVALID_ARGUMENT;
+}
+
+static void WritePadding(std::ostream& stream, uint64_t size)
+{
+    static const char zeros[0x1000] = {0};
+    while (size > 0) {
+        const uint32_t length = static_cast<uint32_t>(std::min<uint64_t>(size, sizeof(zeros)));
+        stream.write(zeros, length);
+        size -= length;
+    }
+}
+
 Result ReadEntryBuffer(const std::vector<uint8_t>& archive_buffer, const TabEntry& entry,
                        std::vector<uint8_t>* out_buffer, const std::vector<TabCompressedBlock>& compression_blocks)
 {
@@ -78,27 +162,32 @@ Result ReadEntryBuffer(const std::vector<uint8_t>& archive_buffer, const TabEntr
         return E_TAB_INPUT_REQUIRES_COMPRESSION_BLOCKS;
     }
 
-    // entry isn't using compression, read directly from the buffer
-    if (entry.m_Library == E_COMPRESS_LIBRARY_NONE) {
-        assert(entry.m_Size != 0);
-        out_buffer->resize(entry.m_Size);
+    out_buffer->resize(GetEntryDecompressedSize(entry));
 
-        // copy the buffer from the input buffer
-        std::memcpy(out_buffer->data(), archive_buffer.data() + entry.m_Offset, entry.m_Size);
+    const Result result = ReadEntryBuffer(archive_buffer.data(), archive_buffer.size(), entry, out_buffer->data(),
+                                          out_buffer->size(), compression_blocks);
+    if (AVA_FL_FAILED(result)) {
+        out_buffer->clear();
     }
-    // entry is using compression, decompress the entry buffer
-    else {
-        // figure out how much space we need (if compression blocks are used, we will get the total size of all blocks)
-        const uint32_t size = GetEntryRequiredBufferSize(entry, compression_blocks);
 
-        // copy the compressed buffer from the archive buffer
-        std::vector<uint8_t> compressed_buffer(entry.m_Size);
-        std::memcpy(compressed_buffer.data(), archive_buffer.data() + entry.m_Offset, size);
+    return result;
+}
 
-        return DecompressEntryBuffer(compressed_buffer, entry, out_buffer, compression_blocks);
+Result ReadEntryBuffer(const uint8_t* archive_buffer, const size_t archive_buffer_size, const TabEntry& entry,
+                       uint8_t* out_buffer, const size_t out_buffer_size,
+                       const std::vector<TabCompressedBlock>& compression_blocks)
+{
+    if (!archive_buffer || archive_buffer_size == 0 || !out_buffer) {
+        return E_INVALID_ARGUMENT;
     }
 
-    return E_OK;
+    if ((static_cast<uint64_t>(entry.m_Offset) + entry.m_Size) > archive_buffer_size) {
+        return E_TAB_ENTRY_OUT_OF_BOUNDS;
+    }
+
+    // decompress straight from the archive buffer
+    return DecompressEntryBuffer(archive_buffer + entry.m_Offset, entry.m_Size, entry, out_buffer, out_buffer_size,
+                                 compression_blocks);
 }
 
 Result DecompressEntryBuffer(const std::vector<uint8_t>& buffer, const TabEntry& entry,
@@ -110,96 +199,119 @@ Result DecompressEntryBuffer(const std::vector<uint8_t>& buffer, const TabEntry&
         return E_INVALID_ARGUMENT;
     }
 
+    out_buffer->resize(GetEntryDecompressedSize(entry));
+
+    const Result result = DecompressEntryBuffer(buffer.data(), buffer.size(), entry, out_buffer->data(),
+                                                out_buffer->size(), compression_blocks);
+    if (AVA_FL_FAILED(result)) {
+        out_buffer->clear();
+    }
+
+    return result;
+}
+
+Result DecompressEntryBuffer(const uint8_t* buffer, const size_t buffer_size, const TabEntry& entry,
+                             uint8_t* out_buffer, const size_t out_buffer_size,
+                             const std::vector<TabCompressedBlock>& compression_blocks)
+{
+    if (!buffer || buffer_size == 0 || !out_buffer) {
+        // throw std::invalid_argument("input buffer can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
     if (entry.m_CompressedBlockIndex != 0 && compression_blocks.empty()) {
         // throw std::invalid_argument("entry uses compression blocks, but none were passed.");
         return E_TAB_INPUT_REQUIRES_COMPRESSION_BLOCKS;
     }
 
-    // read the entry buffer from the input buffer
-    switch (entry.m_Library) {
-        case E_COMPRESS_LIBRARY_NONE: {
-            assert(entry.m_Size != 0);
-            out_buffer->resize(entry.m_Size);
+    if (buffer_size < entry.m_Size || out_buffer_size < GetEntryDecompressedSize(entry)) {
+        return E_TAB_ENTRY_OUT_OF_BOUNDS;
+    }
 
-            // copy the buffer from the input buffer
-            std::memcpy(out_buffer->data(), buffer.data(), entry.m_Size);
-            break;
-        }
+    // entry isn't using compression, read directly from the buffer
+    if (entry.m_Library == E_COMPRESS_LIBRARY_NONE) {
+        assert(entry.m_Size != 0);
 
-        case E_COMPRESS_LIBRARY_ZLIB: {
+        // copy the buffer from the input buffer
+        std::memcpy(out_buffer, buffer, entry.m_Size);
+        return E_OK;
+    }
+
+    if (entry.m_Library != E_COMPRESS_LIBRARY_ZLIB && entry.m_Library != E_COMPRESS_LIBRARY_OODLE) {
+        return E_NOT_IMPLEMENTED;
+    }
+
+    // entry is not using compression blocks
+    if (entry.m_CompressedBlockIndex == 0) {
+        assert(entry.m_Size != entry.m_UncompressedSize);
+
+        // ensure the decompressed amount what we expected
+        if (!DecompressBlock(entry.m_Library, buffer, entry.m_Size, out_buffer, entry.m_UncompressedSize)) {
 #ifdef _DEBUG
             __debugbreak();
 #endif
-            // throw std::runtime_error("Zlib Decompression not implemented!");
-            return E_NOT_IMPLEMENTED;
-            break;
+            return E_TAB_DECOMPRESS_BLOCK_FAILED;
         }
 
-        case E_COMPRESS_LIBRARY_OODLE: {
-            // entry is not using compression blocks
-            if (entry.m_CompressedBlockIndex == 0) {
-                // copy the compressed buffer from the arc input buffer
-                std::vector<uint8_t> compressed_data(entry.m_Size);
-                std::memcpy(compressed_data.data(), buffer.data(), entry.m_Size);
+        return E_OK;
+    }
 
-                assert(entry.m_Size != entry.m_UncompressedSize);
+    // entry is using compression blocks
+    struct BlockRange {
+        const TabCompressedBlock* m_Block;
+        uint32_t                  m_CompressedOffset;
+        uint32_t                  m_UncompressedOffset;
+    };
+
+    // blocks are stored back to back, so the offsets of every block can be calculated up front
+    std::vector<BlockRange> blocks;
+    uint16_t                current_block_index     = entry.m_CompressedBlockIndex;
+    uint32_t                total_compressed_size   = 0;
+    uint32_t                total_uncompressed_size = 0;
+
+    while (total_compressed_size < entry.m_Size) {
+        if (current_block_index >= compression_blocks.size()
+            || compression_blocks[current_block_index].m_CompressedSize == 0) {
+            return E_TAB_DECOMPRESS_BLOCK_FAILED;
+        }
 
-                // uncompress the buffer
-                out_buffer->resize(entry.m_UncompressedSize);
-                const int64_t size = ava::Oodle::Decompress(compressed_data.data(), entry.m_Size, out_buffer->data(),
-                                                            entry.m_UncompressedSize);
+        const TabCompressedBlock& block = compression_blocks[current_block_index];
+        blocks.push_back({&block, total_compressed_size, total_uncompressed_size});
 
-                // ensure the decompressed amount what we expected
-                if (size != entry.m_UncompressedSize) {
-#ifdef _DEBUG
-                    __debugbreak();
-#endif
-                    out_buffer->clear();
-                    return E_TAB_DECOMPRESS_BLOCK_FAILED;
-                }
-            }
-            // entry is using compression blocks
-            else {
-                out_buffer->resize(entry.m_UncompressedSize);
-
-                uint16_t current_block_index     = entry.m_CompressedBlockIndex;
-                uint32_t archive_buffer_offset   = 0;
-                uint32_t total_compressed_size   = entry.m_Size;
-                uint32_t total_uncompressed_size = 0;
-
-                while (total_compressed_size > 0) {
-                    const TabCompressedBlock& block = compression_blocks.at(current_block_index);
-
-                    // read the compressed block
-                    std::vector<uint8_t> block_data(block.m_CompressedSize);
-                    std::memcpy(block_data.data(), buffer.data() + archive_buffer_offset, block.m_CompressedSize);
-
-                    // decompress the block data
-                    const int64_t size =
-                        ava::Oodle::Decompress(block_data.data(), block.m_CompressedSize,
-                                               out_buffer->data() + total_uncompressed_size, block.m_UncompressedSize);
-                    if (size != block.m_UncompressedSize) {
-#ifdef _DEBUG
-                        __debugbreak();
-#endif
-                        out_buffer->clear();
-                        return E_TAB_DECOMPRESS_BLOCK_FAILED;
-                    }
-
-                    total_compressed_size -= block.m_CompressedSize;
-                    total_uncompressed_size += block.m_UncompressedSize;
-                    archive_buffer_offset += block.m_CompressedSize;
-                    current_block_index++;
-                }
-            }
+        total_compressed_size += block.m_CompressedSize;
+        total_uncompressed_size += block.m_UncompressedSize;
+        current_block_index++;
+    }
 
-            break;
+    if (total_compressed_size > buffer_size || total_uncompressed_size != entry.m_UncompressedSize) {
+        return E_TAB_DECOMPRESS_BLOCK_FAILED;
+    }
+
+    // every block decodes on its own, decompress them across the thread pool
+    std::atomic<bool> failed = false;
+    utils::parallel_for(utils::ThreadPool::shared(), blocks.size(), [&](const size_t i) {
+        const BlockRange& range = blocks[i];
+        if (!DecompressBlock(entry.m_Library, buffer + range.m_CompressedOffset, range.m_Block->m_CompressedSize,
+                             out_buffer + range.m_UncompressedOffset, range.m_Block->m_UncompressedSize)) {
+            failed = true;
         }
+    });
+
+    if (failed) {
+#ifdef _DEBUG
+        __debugbreak();
+#endif
+        return E_TAB_DECOMPRESS_BLOCK_FAILED;
     }
 
     return E_OK;
 }
 
+uint32_t GetEntryDecompressedSize(const TabEntry& entry)
+{
+    return (entry.m_Library == E_COMPRESS_LIBRARY_NONE ? entry.m_Size : entry.m_UncompressedSize);
+}
+
 uint32_t GetEntryRequiredBufferSize(const TabEntry& entry, const std::vector<TabCompressedBlock>& compression_blocks)
 {
     if (entry.m_Library != E_COMPRESS_LIBRARY_NONE || entry.m_CompressedBlockIndex == 0) {
@@ -264,41 +376,32 @@ Result WriteEntry(std::vector<uint8_t>* out_tab_buffer, std::vector<uint8_t>* ou
             break;
         }
 
-        case E_COMPRESS_LIBRARY_ZLIB: {
-#ifdef _DEBUG
-            __debugbreak();
-#endif
-            // throw std::runtime_error("Zlib Crompression not implemented!");
-            return E_NOT_IMPLEMENTED;
-            break;
-        }
-
+        case E_COMPRESS_LIBRARY_ZLIB:
         case E_COMPRESS_LIBRARY_OODLE: {
             // entry is not using compression blocks
             if (entry.m_CompressedBlockIndex == 0) {
                 std::vector<uint8_t> compressed_data;
-                const int64_t        size = ava::Oodle::Compress(&file_buffer, &compressed_data);
-
-                // update entry
-                entry.m_Size  = static_cast<uint32_t>(size);
-                entry.m_Flags = E_ENTRY_FLAG_DECODE_BUFFER;
-
-                if (size == 0) {
+                const Result         result =
+                    CompressBlock(compression, file_buffer.data(), file_buffer.size(), &compressed_data);
+                if (AVA_FL_FAILED(result)) {
 #ifdef _DEBUG
                     __debugbreak();
 #endif
                     return E_TAB_COMPRESS_BLOCK_FAILED;
                 }
 
+                // update entry
+                entry.m_Size  = static_cast<uint32_t>(compressed_data.size());
+                entry.m_Flags = E_ENTRY_FLAG_DECODE_BUFFER;
+
                 // write the compressed buffer to the arc buffer
-                // TODO : memcpy
-                std::copy(compressed_data.begin(), compressed_data.end(), std::back_inserter(*out_arc_buffer));
+                out_arc_buffer->insert(out_arc_buffer->end(), compressed_data.begin(), compressed_data.end());
             } else {
 #ifdef _DEBUG
                 __debugbreak();
 #endif
                 return E_NOT_IMPLEMENTED;
-                // throw std::runtime_error("CompressionType_Oodle: Compression blocks not implemented!");
+                // throw std::runtime_error("Compression blocks not implemented! (use ArchiveBuilder)");
             }
 
             break;
@@ -309,4 +412,605 @@ Result WriteEntry(std::vector<uint8_t>* out_tab_buffer, std::vector<uint8_t>* ou
     buf.write(entry);
     return E_OK;
 }
+
+void EntryIndex::Build(std::vector<TabEntry> entries)
+{
+    m_Entries = std::move(entries);
+
+    m_Index.clear();
+    m_Index.reserve(m_Entries.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Entries.size()); ++i) {
+        m_Index.insert(m_Entries[i].m_NameHash, i);
+    }
+}
+
+Result EntryIndex::ReadEntry(const uint32_t name_hash, TabEntry* out_entry) const
+{
+    if (!out_entry) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const TabEntry* entry = Find(name_hash);
+    if (!entry) {
+        return E_TAB_UNKNOWN_ENTRY;
+    }
+
+    *out_entry = *entry;
+    return E_OK;
+}
+
+void EntryIndex::Clear()
+{
+    m_Entries.clear();
+    m_Index.clear();
+}
+
+Result ArchiveHandle::Open(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename)
+{
+    Close();
+
+    // the TAB file is small, so read it into memory and parse it once
+    std::vector<uint8_t> tab_buffer;
+    {
+        std::ifstream stream(tab_filename, std::ios::binary | std::ios::ate);
+        if (stream.fail()) {
+            return E_FAILED_TO_OPEN_FILE;
+        }
+
+        tab_buffer.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read((char*)tab_buffer.data(), tab_buffer.size());
+    }
+
+    if (tab_buffer.size() < sizeof(TabHeader)) {
+        return E_TAB_INVALID_MAGIC;
+    }
+
+    std::vector<TabEntry> entries;
+    const Result          result = Parse(tab_buffer, &entries, &m_CompressionBlocks);
+    if (AVA_FL_FAILED(result)) {
+        Close();
+        return result;
+    }
+
+    m_Index.Build(std::move(entries));
+    std::memcpy(&m_Header, tab_buffer.data(), sizeof(TabHeader));
+
+    if (!m_ArcFile.open(arc_filename)) {
+        Close();
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    return E_OK;
+}
+
+void ArchiveHandle::Close()
+{
+    m_Header = TabHeader{};
+    m_Index.Clear();
+    m_CompressionBlocks.clear();
+    m_ArcFile.close();
+}
+
+Result ArchiveHandle::ReadEntry(const uint32_t name_hash, TabEntry* out_entry) const
+{
+    return m_Index.ReadEntry(name_hash, out_entry);
+}
+
+Result ArchiveHandle::ReadEntryBuffer(const TabEntry& entry, std::vector<uint8_t>* out_buffer) const
+{
+    if (!IsOpen() || !out_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    out_buffer->resize(GetEntryDecompressedSize(entry));
+
+    const Result result = ReadEntryBuffer(entry, out_buffer->data(), out_buffer->size());
+    if (AVA_FL_FAILED(result)) {
+        out_buffer->clear();
+    }
+
+    return result;
+}
+
+Result ArchiveHandle::ReadEntryBuffer(const TabEntry& entry, uint8_t* out_buffer, const size_t out_buffer_size) const
+{
+    if (!IsOpen() || !out_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    // only the pages backing this entry are touched, and they are decompressed straight from the mapping
+    return ava::ArchiveTable::ReadEntryBuffer(m_ArcFile.data(), m_ArcFile.size(), entry, out_buffer, out_buffer_size,
+                                              m_CompressionBlocks);
+}
+
+Result ArchiveHandle::ReadEntryBuffer(const uint32_t name_hash, std::vector<uint8_t>* out_buffer) const
+{
+    TabEntry entry{};
+    const Result result = ReadEntry(name_hash, &entry);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    return ReadEntryBuffer(entry, out_buffer);
+}
+
+Result ArchiveHandle::ReadEntryBuffers(const std::vector<uint32_t>& name_hashes, const BatchCallback& callback,
+                                       const uint32_t num_workers, BatchStats* out_stats) const
+{
+    if (!IsOpen() || !callback) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // resolve all the entries, and sort them by their offset so the archive is read sequentially
+    std::vector<const TabEntry*> entries(name_hashes.size());
+    std::transform(name_hashes.begin(), name_hashes.end(), entries.begin(),
+                   [this](const uint32_t name_hash) { return m_Index.Find(name_hash); });
+
+    std::vector<uint32_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+        // unknown entries are reported last
+        const uint64_t lhs_offset = (entries[lhs] ? entries[lhs]->m_Offset : UINT64_MAX);
+        const uint64_t rhs_offset = (entries[rhs] ? entries[rhs]->m_Offset : UINT64_MAX);
+        return lhs_offset < rhs_offset;
+    });
+
+    std::atomic<uint32_t> num_entries   = 0;
+    std::atomic<uint32_t> num_failed    = 0;
+    std::atomic<uint64_t> bytes_read    = 0;
+    std::atomic<uint64_t> bytes_written = 0;
+
+    // indices are handed out in ascending order, so reads stay sequential across the workers
+    const auto read_entry = [&](const size_t i) {
+        const uint32_t  index = order[i];
+        const TabEntry* entry = entries[index];
+
+        if (!entry) {
+            TabEntry unknown_entry{};
+            unknown_entry.m_NameHash = name_hashes[index];
+
+            num_failed++;
+            callback(unknown_entry, E_TAB_UNKNOWN_ENTRY, {});
+            return;
+        }
+
+        std::vector<uint8_t> buffer;
+        const Result         result = ReadEntryBuffer(*entry, &buffer);
+        if (AVA_FL_SUCCEEDED(result)) {
+            num_entries++;
+            bytes_read += entry->m_Size;
+            bytes_written += buffer.size();
+        } else {
+            num_failed++;
+        }
+
+        callback(*entry, result, std::move(buffer));
+    };
+
+    uint32_t workers = 0;
+    if (num_workers == 0) {
+        workers = static_cast<uint32_t>(utils::ThreadPool::shared().size()) + 1;
+        utils::parallel_for(utils::ThreadPool::shared(), order.size(), read_entry);
+    } else if (num_workers == 1) {
+        workers = 1;
+        for (size_t i = 0; i < order.size(); ++i) {
+            read_entry(i);
+        }
+    } else {
+        // the calling thread is one of the workers
+        utils::ThreadPool pool(num_workers - 1);
+        workers = num_workers;
+        utils::parallel_for(pool, order.size(), read_entry);
+    }
+
+    if (out_stats) {
+        out_stats->m_NumWorkers     = workers;
+        out_stats->m_NumEntries     = num_entries;
+        out_stats->m_NumFailed      = num_failed;
+        out_stats->m_BytesRead      = bytes_read;
+        out_stats->m_BytesWritten   = bytes_written;
+        out_stats->m_ElapsedSeconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    }
+
+    return E_OK;
+}
+
+Result ArchiveBuilder::Open(const std::filesystem::path& arc_filename)
+{
+    m_ArcStream.close();
+    m_ArcStream.open(arc_filename, std::ios::binary | std::ios::trunc);
+    if (m_ArcStream.fail()) {
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    m_ArcSize = 0;
+    m_Entries.clear();
+    m_CompressionBlocks.clear();
+    m_PendingEntries.clear();
+    m_PendingSize = 0;
+    return E_OK;
+}
+
+Result ArchiveBuilder::AddEntry(const std::string& filename, std::vector<uint8_t> file_buffer,
+                                ECompressLibrary compression)
+{
+    if (filename.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    return AddEntry(ava::hashlittle(filename.c_str()), std::move(file_buffer), compression);
+}
+
+Result ArchiveBuilder::AddEntry(const uint32_t name_hash, std::vector<uint8_t> file_buffer,
+                                ECompressLibrary compression)
+{
+    if (!m_ArcStream.is_open() || file_buffer.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    m_PendingSize += file_buffer.size();
+    m_PendingEntries.push_back({name_hash, compression, std::move(file_buffer)});
+
+    if (m_PendingSize >= m_MaxPendingSize) {
+        return Flush();
+    }
+
+    return E_OK;
+}
+
+Result ArchiveBuilder::Flush()
+{
+    if (!m_ArcStream.is_open()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    struct Job {
+        const uint8_t*       m_Data    = nullptr;
+        uint32_t             m_Size    = 0;
+        ECompressLibrary     m_Library = E_COMPRESS_LIBRARY_NONE;
+        std::vector<uint8_t> m_Output  = {};
+        Result               m_Result = E_OK;
+    };
+
+    // split the pending entries into compression jobs
+    const uint32_t        block_size = m_Header.m_UncompressedBlockSize;
+    std::vector<Job>      jobs;
+    std::vector<uint32_t> first_job(m_PendingEntries.size());
+    for (size_t i = 0; i < m_PendingEntries.size(); ++i) {
+        const PendingEntry& pending = m_PendingEntries[i];
+        const uint32_t      size    = static_cast<uint32_t>(pending.m_Buffer.size());
+
+        first_job[i] = static_cast<uint32_t>(jobs.size());
+        if (pending.m_Library == E_COMPRESS_LIBRARY_NONE) {
+            continue;
+        }
+
+        if (block_size == 0 || size <= block_size) {
+            jobs.push_back({pending.m_Buffer.data(), size, pending.m_Library});
+            continue;
+        }
+
+        for (uint32_t offset = 0; offset < size; offset += block_size) {
+            jobs.push_back({pending.m_Buffer.data() + offset, std::min(block_size, size - offset), pending.m_Library});
+        }
+    }
+
+    // compress everything in parallel
+    utils::parallel_for(utils::ThreadPool::shared(), jobs.size(), [&](const size_t i) {
+        Job& job     = jobs[i];
+        job.m_Result = CompressBlock(job.m_Library, job.m_Data, job.m_Size, &job.m_Output);
+    });
+
+    for (const Job& job : jobs) {
+        if (AVA_FL_FAILED(job.m_Result)) {
+#ifdef _DEBUG
+            __debugbreak();
+#endif
+            return job.m_Result;
+        }
+    }
+
+    // write the entries in the order they were added
+    for (size_t i = 0; i < m_PendingEntries.size(); ++i) {
+        const PendingEntry& pending = m_PendingEntries[i];
+
+        // align the entry
+        if (m_Header.m_Alignment > 0) {
+            const uint32_t padding = ava::math::align_distance(m_ArcSize, m_Header.m_Alignment);
+            WritePadding(m_ArcStream, padding);
+            m_ArcSize += padding;
+        }
+
+        if (m_ArcSize > UINT32_MAX) {
+            return E_TAB_ENTRY_OUT_OF_BOUNDS;
+        }
+
+        TabEntry entry{};
+        entry.m_NameHash             = pending.m_NameHash;
+        entry.m_Offset               = static_cast<uint32_t>(m_ArcSize);
+        entry.m_Size                 = 0;
+        entry.m_UncompressedSize     = static_cast<uint32_t>(pending.m_Buffer.size());
+        entry.m_CompressedBlockIndex = 0;
+        entry.m_Library              = pending.m_Library;
+        entry.m_Flags                = E_ENTRY_FLAG_DECODE_NONE;
+
+        if (pending.m_Library == E_COMPRESS_LIBRARY_NONE) {
+            entry.m_Size = entry.m_UncompressedSize;
+            m_ArcStream.write((const char*)pending.m_Buffer.data(), pending.m_Buffer.size());
+        } else {
+            const uint32_t job_begin = first_job[i];
+            const uint32_t job_end   = ((i + 1) < first_job.size() ? first_job[i + 1] : (uint32_t)jobs.size());
+
+            // entry is using compression blocks
+            if ((job_end - job_begin) > 1) {
+                // block index 0 means "no compression blocks", so the table starts with a placeholder
+                if (m_CompressionBlocks.empty()) {
+                    m_CompressionBlocks.push_back({0xFFFFFFFF, 0xFFFFFFFF});
+                }
+
+                if ((m_CompressionBlocks.size() + (job_end - job_begin)) > UINT16_MAX) {
+                    return E_TAB_COMPRESS_BLOCK_FAILED;
+                }
+
+                entry.m_CompressedBlockIndex = static_cast<uint16_t>(m_CompressionBlocks.size());
+            }
+
+            for (uint32_t x = job_begin; x < job_end; ++x) {
+                const Job&     job             = jobs[x];
+                const uint32_t compressed_size = static_cast<uint32_t>(job.m_Output.size());
+
+                if (entry.m_CompressedBlockIndex != 0) {
+                    m_CompressionBlocks.push_back({compressed_size, job.m_Size});
+                    m_Header.m_MaxCompressedBlockSize = std::max(m_Header.m_MaxCompressedBlockSize, compressed_size);
+                }
+
+                m_ArcStream.write((const char*)job.m_Output.data(), compressed_size);
+                entry.m_Size += compressed_size;
+            }
+
+            entry.m_Flags = E_ENTRY_FLAG_DECODE_BUFFER;
+        }
+
+        m_ArcSize += entry.m_Size;
+        m_Entries.push_back(entry);
+    }
+
+    m_PendingEntries.clear();
+    m_PendingSize = 0;
+
+    m_ArcStream.flush();
+    return m_ArcStream.fail() ? E_FAILED_TO_WRITE_FILE : E_OK;
+}
+
+Result ArchiveBuilder::Finish(std::vector<uint8_t>* out_tab_buffer)
+{
+    if (!out_tab_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const Result result = Flush();
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    m_ArcStream.close();
+
+    // write the tab file
+    out_tab_buffer->clear();
+    utils::ByteVectorStream buf(out_tab_buffer);
+
+    buf.write(m_Header);
+    buf.write(static_cast<uint32_t>(m_CompressionBlocks.size()));
+    buf.write(m_CompressionBlocks.data(), sizeof(TabCompressedBlock) * m_CompressionBlocks.size());
+    buf.write(m_Entries.data(), sizeof(TabEntry) * m_Entries.size());
+    return E_OK;
+}
+
+Result ArchiveBuilder::Finish(const std::filesystem::path& tab_filename)
+{
+    std::vector<uint8_t> tab_buffer;
+
+    const Result result = Finish(&tab_buffer);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    std::ofstream stream(tab_filename, std::ios::binary | std::ios::trunc);
+    if (stream.fail()) {
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    stream.write((const char*)tab_buffer.data(), tab_buffer.size());
+    return stream.fail() ? E_FAILED_TO_WRITE_FILE : E_OK;
+}
+
+Result ArchivePatcher::Open(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename)
+{
+    Close();
+
+    m_TabStream.open(tab_filename, std::ios::binary | std::ios::in | std::ios::out);
+    m_ArcStream.open(arc_filename, std::ios::binary | std::ios::in | std::ios::out);
+    if (m_TabStream.fail() || m_ArcStream.fail()) {
+        Close();
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    std::vector<uint8_t> tab_buffer;
+    m_TabStream.seekg(0, std::ios::end);
+    tab_buffer.resize(static_cast<size_t>(m_TabStream.tellg()));
+    m_TabStream.seekg(0);
+    m_TabStream.read((char*)tab_buffer.data(), tab_buffer.size());
+
+    if (tab_buffer.size() < sizeof(TabHeader)) {
+        Close();
+        return E_TAB_INVALID_MAGIC;
+    }
+
+    std::vector<TabCompressedBlock> compression_blocks;
+    const Result                    result = Parse(tab_buffer, &m_Entries, &compression_blocks);
+    if (AVA_FL_FAILED(result)) {
+        Close();
+        return result;
+    }
+
+    std::memcpy(&m_Header, tab_buffer.data(), sizeof(TabHeader));
+    m_NumCompressionBlocks = static_cast<uint32_t>(compression_blocks.size());
+
+    // index the entries (the first entry of a duplicated name hash wins, like EntryIndex)
+    m_Index.reserve(m_Entries.size());
+    m_SortedOffsets.reserve(m_Entries.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Entries.size()); ++i) {
+        m_Index.insert(m_Entries[i].m_NameHash, i);
+        m_SortedOffsets.push_back(m_Entries[i].m_Offset);
+    }
+
+    std::sort(m_SortedOffsets.begin(), m_SortedOffsets.end());
+
+    m_ArcStream.seekg(0, std::ios::end);
+    m_ArcSize = static_cast<uint64_t>(m_ArcStream.tellg());
+    return E_OK;
+}
+
+void ArchivePatcher::Close()
+{
+    m_TabStream.close();
+    m_ArcStream.close();
+    m_TabStream.clear();
+    m_ArcStream.clear();
+
+    m_Header = TabHeader{};
+    m_Entries.clear();
+    m_Index.clear();
+    m_SortedOffsets.clear();
+    m_NumCompressionBlocks = 0;
+    m_ArcSize              = 0;
+}
+
+Result ArchivePatcher::PatchEntry(const std::string& filename, const std::vector<uint8_t>& file_buffer,
+                                  ECompressLibrary compression, bool* out_in_place)
+{
+    if (filename.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    return PatchEntry(ava::hashlittle(filename.c_str()), file_buffer, compression, out_in_place);
+}
+
+Result ArchivePatcher::PatchEntry(const uint32_t name_hash, const std::vector<uint8_t>& file_buffer,
+                                  ECompressLibrary compression, bool* out_in_place)
+{
+    if (!IsOpen() || file_buffer.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    TabEntry entry{};
+    entry.m_NameHash             = name_hash;
+    entry.m_Size                 = static_cast<uint32_t>(file_buffer.size());
+    entry.m_UncompressedSize     = entry.m_Size;
+    entry.m_CompressedBlockIndex = 0;
+    entry.m_Library              = compression;
+    entry.m_Flags                = E_ENTRY_FLAG_DECODE_NONE;
+
+    const uint8_t*       data = file_buffer.data();
+    std::vector<uint8_t> compressed_data;
+    if (compression != E_COMPRESS_LIBRARY_NONE) {
+        const Result result = CompressBlock(compression, file_buffer.data(), file_buffer.size(), &compressed_data);
+        if (AVA_FL_FAILED(result)) {
+#ifdef _DEBUG
+            __debugbreak();
+#endif
+            return E_TAB_COMPRESS_BLOCK_FAILED;
+        }
+
+        data          = compressed_data.data();
+        entry.m_Size  = static_cast<uint32_t>(compressed_data.size());
+        entry.m_Flags = E_ENTRY_FLAG_DECODE_BUFFER;
+    }
+
+    // the old slot ends at the aligned old size, or the next entry if that's closer
+    uint32_t index    = m_Index.find(name_hash);
+    bool     in_place = false;
+    TabEntry old_entry{};
+    if (index != utils::HashIndex::INVALID_VALUE) {
+        old_entry = m_Entries[index];
+
+        uint64_t slot_size = old_entry.m_Size;
+        if (m_Header.m_Alignment > 0) {
+            slot_size = ava::math::align<uint64_t>(slot_size, m_Header.m_Alignment);
+        }
+
+        const auto [first, next] = std::equal_range(m_SortedOffsets.begin(), m_SortedOffsets.end(), old_entry.m_Offset);
+        if (next != m_SortedOffsets.end()) {
+            slot_size = std::min<uint64_t>(slot_size, (*next - old_entry.m_Offset));
+        }
+
+        // deduplicated entries share their data with other entries, so their slot can't be overwritten
+        const bool shared = (std::distance(first, next) > 1);
+        in_place          = (!shared && entry.m_Size <= slot_size);
+    }
+
+    if (in_place) {
+        entry.m_Offset = old_entry.m_Offset;
+
+        // clear the rest of the old entry so no stale data is left in the slot
+        m_ArcStream.seekp(entry.m_Offset);
+        m_ArcStream.write((const char*)data, entry.m_Size);
+        if (entry.m_Size < old_entry.m_Size) {
+            WritePadding(m_ArcStream, (old_entry.m_Size - entry.m_Size));
+        }
+
+        m_ArcSize = std::max<uint64_t>(m_ArcSize, (static_cast<uint64_t>(entry.m_Offset) + entry.m_Size));
+    } else {
+        const uint32_t padding =
+            (m_Header.m_Alignment > 0 ? ava::math::align_distance(m_ArcSize, m_Header.m_Alignment) : 0);
+        if ((m_ArcSize + padding + entry.m_Size) > UINT32_MAX) {
+            return E_TAB_ENTRY_OUT_OF_BOUNDS;
+        }
+
+        entry.m_Offset = static_cast<uint32_t>(m_ArcSize + padding);
+
+        m_ArcStream.seekp(m_ArcSize);
+        WritePadding(m_ArcStream, padding);
+        m_ArcStream.write((const char*)data, entry.m_Size);
+
+        m_ArcSize = (static_cast<uint64_t>(entry.m_Offset) + entry.m_Size);
+
+        // the entry doesn't use its old slot anymore (appended offsets are always the largest, so it stays sorted)
+        if (index != utils::HashIndex::INVALID_VALUE) {
+            const auto old_offset =
+                std::lower_bound(m_SortedOffsets.begin(), m_SortedOffsets.end(), old_entry.m_Offset);
+            m_SortedOffsets.erase(old_offset);
+        }
+
+        m_SortedOffsets.push_back(entry.m_Offset);
+    }
+
+    // rewrite only the affected entry record, new entries are appended to the end of the TAB file
+    if (index == utils::HashIndex::INVALID_VALUE) {
+        index = static_cast<uint32_t>(m_Entries.size());
+        m_Entries.push_back(entry);
+        m_Index.insert(name_hash, index);
+    } else {
+        m_Entries[index] = entry;
+    }
+
+    m_TabStream.seekp(GetEntryRecordOffset(index));
+    m_TabStream.write((const char*)&entry, sizeof(TabEntry));
+
+    m_TabStream.flush();
+    m_ArcStream.flush();
+    if (m_TabStream.fail() || m_ArcStream.fail()) {
+        return E_FAILED_TO_WRITE_FILE;
+    }
+
+    if (out_in_place) {
+        *out_in_place = in_place;
+    }
+
+    return E_OK;
+}
 }; // namespace ava::ArchiveTable
@@ -1,67 +1,160 @@
 #include <archives/avalanche_archive_format.h>
 
-#include <util/byte_array_buffer.h>
 #include <util/byte_vector_stream.h>
 #include <util/hashlittle.h>
 #include <util/math.h>
+#include <util/thread_pool.h>
 #include <util/zlib.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
 namespace ava::AvalancheArchiveFormat
 {
+static_assert(CompressOptions{}.m_Level == Z_DEFAULT_COMPRESSION && CompressOptions{}.m_Strategy == Z_DEFAULT_STRATEGY
+                  && CompressOptions{}.m_MemLevel == DEF_MEM_LEVEL,
+              "CompressOptions defaults don't match zlib!");
+
+Result BuildChunkIndex(const uint8_t* buffer, const size_t buffer_size, std::vector<ChunkRange>* out_chunks,
+                       uint64_t* out_total_size)
+{
+    if (!buffer || !out_chunks) {
+        // throw std::invalid_argument("AAF input buffer can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    if (buffer_size < sizeof(AafHeader)) {
+        // throw std::runtime_error("Invalid AAF header magic!");
+        return E_AAF_INVALID_MAGIC;
+    }
+
+    AafHeader header;
+    std::memcpy(&header, buffer, sizeof(AafHeader));
+    if (header.m_Magic != AAF_MAGIC) {
+        // throw std::runtime_error("Invalid AAF header magic!");
+        return E_AAF_INVALID_MAGIC;
+    }
+
+    // don't trust the chunk count for the reservation, every chunk needs at least a chunk header
+    out_chunks->clear();
+    out_chunks->reserve(std::min<size_t>(header.m_NumChunks, (buffer_size - sizeof(AafHeader)) / sizeof(AafChunk)));
+
+    uint64_t offset            = sizeof(AafHeader);
+    uint64_t decompressed_size = 0;
+    for (uint32_t i = 0; i < header.m_NumChunks; ++i) {
+        if ((offset + sizeof(AafChunk)) > buffer_size) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
+        ChunkRange range;
+        std::memcpy(&range.m_Chunk, buffer + offset, sizeof(AafChunk));
+        if (range.m_Chunk.m_Magic != AAF_CHUNK_MAGIC) {
+            // throw std::runtime_error("Invalid AAF chunk magic!");
+            return E_AAF_INVALID_CHUNK_MAGIC;
+        }
+
+        // every chunk must move forward past its own data, so the chunk count is bounded by the buffer size
+        if (range.m_Chunk.m_ChunkSize < (sizeof(AafChunk) + range.m_Chunk.m_CompressedSize)) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
+        range.m_CompressedOffset   = (offset + sizeof(AafChunk));
+        range.m_DecompressedOffset = decompressed_size;
+        if ((range.m_CompressedOffset + range.m_Chunk.m_CompressedSize) > buffer_size
+            || range.m_Chunk.m_DecompressedSize > header.m_RequiredUnpackBufferSize) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
+        out_chunks->push_back(range);
+        offset += range.m_Chunk.m_ChunkSize;
+        decompressed_size += range.m_Chunk.m_DecompressedSize;
+    }
+
+    // the output buffer is sized from the chunks, so they must add up to the size in the header
+    if (decompressed_size != header.m_TotalUnpackedSize) {
+        // throw std::runtime_error("AAF chunks don't match the unpacked size!");
+        return E_AAF_CHUNK_OUT_OF_BOUNDS;
+    }
+
+    if (out_total_size) {
+        *out_total_size = decompressed_size;
+    }
+
+    return E_OK;
+}
+
 bool IsCompressed(const std::vector<uint8_t>& buffer)
 {
     return *(uint32_t*)buffer.data() == AAF_MAGIC;
 }
 
 Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_buffer)
+{
+    return Compress(buffer, CompressOptions{}, out_buffer);
+}
+
+Result Compress(const std::vector<uint8_t>& buffer, const CompressOptions& options, std::vector<uint8_t>* out_buffer)
 {
     if (buffer.empty() || !out_buffer) {
         // throw std::invalid_argument("AAF compress input buffer can't be empty!");
         return E_INVALID_ARGUMENT;
     }
 
+    if (options.m_ChunkSize == 0 || options.m_ChunkSize > AAF_MAX_CHUNK_DATA_SIZE) {
+        // throw std::invalid_argument("AAF compress chunk size is out of range!");
+        return E_INVALID_ARGUMENT;
+    }
+
     const uint32_t buffer_size         = static_cast<uint32_t>(buffer.size());
-    const uint32_t num_chunks          = (1 + (buffer_size / AAF_MAX_CHUNK_DATA_SIZE));
+    const uint32_t chunk_data_size     = options.m_ChunkSize;
+    const uint32_t num_chunks          = (1 + (buffer_size / chunk_data_size));
     const bool     has_multiple_chunks = (num_chunks > 1);
 
+    // the thread deflate contexts use the default settings
+    const CompressOptions defaults;
+    const bool            use_thread_context =
+        (options.m_Level == defaults.m_Level && options.m_Strategy == defaults.m_Strategy
+         && options.m_MemLevel == defaults.m_MemLevel);
+
     AafHeader header;
     header.m_TotalUnpackedSize        = buffer_size;
-    header.m_RequiredUnpackBufferSize = (has_multiple_chunks ? AAF_MAX_CHUNK_DATA_SIZE : buffer_size);
+    header.m_RequiredUnpackBufferSize = (has_multiple_chunks ? chunk_data_size : buffer_size);
     header.m_NumChunks                = num_chunks;
 
+    // every chunk compresses on its own, compress them straight from the input buffer across the thread pool
+    std::vector<std::vector<uint8_t>> compressed_chunks(num_chunks);
+    std::vector<int32_t>              results(num_chunks, Z_OK);
+    utils::parallel_for(utils::ThreadPool::shared(), num_chunks, [&](const size_t i) {
+        const uint32_t chunk_offset = static_cast<uint32_t>(i * chunk_data_size);
+        const uint32_t chunk_size   = std::min(chunk_data_size, (buffer_size - chunk_offset));
+
+        // chunks are large, so a custom context per chunk costs next to nothing
+        std::unique_ptr<zlib::Deflater> custom_deflater;
+        if (!use_thread_context) {
+            custom_deflater = std::make_unique<zlib::Deflater>(options.m_Level, -MAX_WBITS, options.m_MemLevel,
+                                                               options.m_Strategy);
+        }
+
+        zlib::Deflater& deflater = (use_thread_context ? zlib::GetThreadDeflater() : *custom_deflater);
+
+        uint32_t compressed_size = deflater.Bound(chunk_size);
+        compressed_chunks[i].resize(compressed_size);
+        results[i] =
+            deflater.Compress(buffer.data() + chunk_offset, chunk_size, compressed_chunks[i].data(), &compressed_size);
+        compressed_chunks[i].resize(compressed_size);
+    });
+
     utils::ByteVectorStream buf(out_buffer);
     buf.write(header);
 
-    // create the chunks
-    uint32_t last_chunk_offset = 0;
+    // stitch the chunks together in order
     for (uint32_t i = 0; i < num_chunks; ++i) {
-        AafChunk             chunk;
-        std::vector<uint8_t> chunk_data;
-
-        // split the data if we have more than 1 chunk
-        if (has_multiple_chunks) {
-            // calculate the current chunk size
-            const uint32_t block_size = (buffer_size - last_chunk_offset);
-            const uint32_t chunk_size =
-                (block_size > AAF_MAX_CHUNK_DATA_SIZE ? (AAF_MAX_CHUNK_DATA_SIZE % block_size) : block_size);
-
-            // copy the current chunk data
-            chunk.m_DecompressedSize = chunk_size;
-            chunk_data               = std::vector<uint8_t>(buffer.begin() + last_chunk_offset,
-                                              buffer.begin() + last_chunk_offset + chunk_size);
-            last_chunk_offset += chunk_size;
-        }
-        // we only have a single chunk, the chunk will contain the whole buffer
-        else {
-            chunk.m_DecompressedSize = buffer_size;
-        }
-
-        // compress the current chunk data
-        uint32_t             compressed_size = compressBound(chunk.m_DecompressedSize);
-        std::vector<uint8_t> compressed_block(compressed_size);
-        const int32_t        result = ava::zlib::Compress((has_multiple_chunks ? chunk_data.data() : buffer.data()),
-                                                          chunk.m_DecompressedSize, compressed_block.data(), &compressed_size);
-        if (result != Z_OK) {
+        if (results[i] != Z_OK) {
 #ifdef _DEBUG
             __debugbreak();
 #endif
@@ -69,8 +162,9 @@ Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_bu
             return E_AAF_COMPRESS_CHUNK_FAILED;
         }
 
-        // update the chunk compressed size
-        chunk.m_CompressedSize = compressed_size;
+        AafChunk chunk;
+        chunk.m_DecompressedSize = std::min(chunk_data_size, (buffer_size - (i * chunk_data_size)));
+        chunk.m_CompressedSize   = static_cast<uint32_t>(compressed_chunks[i].size());
 
         // calculate the padding and data size
         const uint32_t padding =
@@ -79,10 +173,13 @@ Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_bu
 
         // write chunk and compressed data
         buf.write(chunk);
-        buf.write(compressed_block.data(), chunk.m_CompressedSize);
+        buf.write(compressed_chunks[i].data(), chunk.m_CompressedSize);
 
         // write block padding
         buf.write((char*)&AAF_PADDING_BYTE, 1, padding);
+
+        // the compressed chunk isn't needed anymore
+        std::vector<uint8_t>().swap(compressed_chunks[i]);
     }
 
     return E_OK;
@@ -90,44 +187,199 @@ Result Compress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_bu
 
 Result Decompress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_buffer)
 {
-    if (buffer.empty() || !out_buffer) {
+    return Decompress(buffer.data(), buffer.size(), out_buffer);
+}
+
+Result Decompress(const uint8_t* buffer, const size_t buffer_size, std::vector<uint8_t>* out_buffer)
+{
+    if (!buffer || buffer_size == 0 || !out_buffer) {
         // throw std::invalid_argument("AAF decompress input buffer can't be empty!");
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
-    std::istream      stream(&buf);
+    // scan the chunk headers first, they give the exact output offset of every chunk
+    std::vector<ChunkRange> chunks;
+    uint64_t                total_size = 0;
 
-    // read header
-    AafHeader header{};
-    stream.read((char*)&header, sizeof(AafHeader));
-    if (header.m_Magic != AAF_MAGIC) {
+    const Result result = BuildChunkIndex(buffer, buffer_size, &chunks, &total_size);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    const size_t out_offset = out_buffer->size();
+    out_buffer->resize(out_offset + total_size);
+
+    // every chunk inflates on its own, inflate them straight into the output buffer across the thread pool
+    uint8_t*          out_data = (out_buffer->data() + out_offset);
+    std::atomic<bool> failed   = false;
+    utils::parallel_for(utils::ThreadPool::shared(), chunks.size(), [&](const size_t i) {
+        const ChunkRange& range = chunks[i];
+
+        uint32_t      compressed_size   = range.m_Chunk.m_CompressedSize;
+        uint32_t      decompressed_size = range.m_Chunk.m_DecompressedSize;
+        const int32_t result = ava::zlib::Decompress(buffer + range.m_CompressedOffset, &compressed_size,
+                                                     out_data + range.m_DecompressedOffset, &decompressed_size);
+        if (result != Z_OK || decompressed_size != range.m_Chunk.m_DecompressedSize) {
+            failed = true;
+        }
+    });
+
+    if (failed) {
+#ifdef _DEBUG
+        __debugbreak();
+#endif
+        out_buffer->resize(out_offset);
+
+        // throw std::runtime_error("Failed to decompress an AAF chunk!");
+        return E_AAF_DECOMPRESS_CHUNK_FAILED;
+    }
+
+    return E_OK;
+}
+
+Result DecompressRange(const uint8_t* buffer, const size_t buffer_size, const std::vector<ChunkRange>& chunks,
+                       const uint64_t offset, const size_t size, std::vector<uint8_t>* out_buffer)
+{
+    if (!buffer || buffer_size == 0 || !out_buffer) {
+        // throw std::invalid_argument("AAF decompress input buffer can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    const uint64_t total_size =
+        chunks.empty() ? 0 : (chunks.back().m_DecompressedOffset + chunks.back().m_Chunk.m_DecompressedSize);
+    if (offset > total_size || size > (total_size - offset)) {
+        // throw std::out_of_range("AAF decompress range is out of bounds!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    out_buffer->resize(size);
+    if (size == 0) {
+        return E_OK;
+    }
+
+    // first chunk which ends after the range start
+    const auto first =
+        std::upper_bound(chunks.begin(), chunks.end(), offset, [](const uint64_t value, const ChunkRange& range) {
+            return value < (range.m_DecompressedOffset + range.m_Chunk.m_DecompressedSize);
+        });
+
+    const uint64_t    range_end = (offset + size);
+    std::atomic<bool> failed    = false;
+
+    std::vector<const ChunkRange*> covering;
+    for (auto it = first; it != chunks.end() && it->m_DecompressedOffset < range_end; ++it) {
+        covering.push_back(&(*it));
+    }
+
+    utils::parallel_for(utils::ThreadPool::shared(), covering.size(), [&](const size_t i) {
+        const ChunkRange& range = *covering[i];
+
+        // only inflate the chunk up to the end of the range
+        const uint64_t local_start = (std::max(offset, range.m_DecompressedOffset) - range.m_DecompressedOffset);
+        const uint64_t local_end =
+            (std::min<uint64_t>(range_end, range.m_DecompressedOffset + range.m_Chunk.m_DecompressedSize)
+             - range.m_DecompressedOffset);
+        uint8_t* out_data = (out_buffer->data() + (range.m_DecompressedOffset + local_start - offset));
+
+        // the range starts inside the chunk, so inflate the start of the chunk into a scratch buffer first
+        std::vector<uint8_t> chunk_data;
+        uint8_t*             dest = out_data;
+        if (local_start != 0) {
+            chunk_data.resize(local_end);
+            dest = chunk_data.data();
+        }
+
+        const int32_t result = zlib::GetThreadInflater().DecompressPrefix(
+            buffer + range.m_CompressedOffset, range.m_Chunk.m_CompressedSize, dest, (uint32_t)local_end);
+        if (result != Z_OK) {
+            failed = true;
+            return;
+        }
+
+        if (local_start != 0) {
+            std::memcpy(out_data, chunk_data.data() + local_start, (local_end - local_start));
+        }
+    });
+
+    if (failed) {
+#ifdef _DEBUG
+        __debugbreak();
+#endif
+        out_buffer->clear();
+
+        // throw std::runtime_error("Failed to decompress an AAF chunk!");
+        return E_AAF_DECOMPRESS_CHUNK_FAILED;
+    }
+
+    return E_OK;
+}
+
+Result DecompressRange(const uint8_t* buffer, const size_t buffer_size, const uint64_t offset, const size_t size,
+                       std::vector<uint8_t>* out_buffer)
+{
+    std::vector<ChunkRange> chunks;
+
+    const Result result = BuildChunkIndex(buffer, buffer_size, &chunks);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    return DecompressRange(buffer, buffer_size, chunks, offset, size, out_buffer);
+}
+
+Result Decompress(std::istream& stream, const ChunkSink& sink)
+{
+    if (!sink) {
+        // throw std::invalid_argument("AAF decompress sink can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    AafHeader header;
+    if (!stream.read((char*)&header, sizeof(AafHeader)) || header.m_Magic != AAF_MAGIC) {
         // throw std::runtime_error("Invalid AAF header magic!");
         return E_AAF_INVALID_MAGIC;
     }
 
-    out_buffer->reserve(header.m_TotalUnpackedSize);
+    // both buffers only ever grow to the size of the largest chunk
+    std::vector<uint8_t> chunk_data;
+    std::vector<uint8_t> decompressed_chunk_data;
+    decompressed_chunk_data.reserve(header.m_RequiredUnpackBufferSize);
 
-    // read all the chunks
-    uint32_t buffer_offset = 0;
     for (uint32_t i = 0; i < header.m_NumChunks; ++i) {
-        const auto start_pos = stream.tellg();
-
         AafChunk chunk;
-        stream.read((char*)&chunk, sizeof(AafChunk));
+        if (!stream.read((char*)&chunk, sizeof(AafChunk))) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
         if (chunk.m_Magic != AAF_CHUNK_MAGIC) {
             // throw std::runtime_error("Invalid AAF chunk magic!");
             return E_AAF_INVALID_CHUNK_MAGIC;
         }
 
-        // read the chunk data
-        std::vector<uint8_t> chunk_data(chunk.m_CompressedSize);
-        stream.read((char*)chunk_data.data(), chunk.m_CompressedSize);
+        if (chunk.m_ChunkSize < (sizeof(AafChunk) + chunk.m_CompressedSize)) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
+        // the header says how big the biggest chunk is, don't trust chunks which claim to be bigger
+        if (chunk.m_DecompressedSize > header.m_RequiredUnpackBufferSize) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
 
-        // decompress the chunk
-        uint32_t             compressed_size   = chunk.m_CompressedSize;
-        uint32_t             decompressed_size = chunk.m_DecompressedSize;
-        std::vector<uint8_t> decompressed_chunk_data(decompressed_size);
+        chunk_data.resize(chunk.m_CompressedSize);
+        if (!stream.read((char*)chunk_data.data(), chunk.m_CompressedSize)) {
+            // throw std::runtime_error("AAF chunk is out of bounds!");
+            return E_AAF_CHUNK_OUT_OF_BOUNDS;
+        }
+
+        // skip the chunk padding, the last chunk may not be padded
+        stream.ignore(chunk.m_ChunkSize - sizeof(AafChunk) - chunk.m_CompressedSize);
+
+        uint32_t compressed_size   = chunk.m_CompressedSize;
+        uint32_t decompressed_size = chunk.m_DecompressedSize;
+        decompressed_chunk_data.resize(decompressed_size);
 
         const int32_t result = ava::zlib::Decompress(chunk_data.data(), &compressed_size,
                                                      decompressed_chunk_data.data(), &decompressed_size);
@@ -139,8 +391,10 @@ Result Decompress(const std::vector<uint8_t>& buffer, std::vector<uint8_t>* out_
             return E_AAF_DECOMPRESS_CHUNK_FAILED;
         }
 
-        out_buffer->insert(out_buffer->end(), decompressed_chunk_data.begin(), decompressed_chunk_data.end());
-        stream.seekg((uint64_t)start_pos + chunk.m_ChunkSize);
+        const Result sink_result = sink(decompressed_chunk_data.data(), decompressed_size);
+        if (AVA_FL_FAILED(sink_result)) {
+            return sink_result;
+        }
     }
 
     return E_OK;
@@ -6,9 +6,9 @@
 
 namespace ava::Oodle
 {
-Result LoadLib(const char* oodle_dll_path)
+Result Codec::Load(const char* oodle_dll_path)
 {
-    if (oodle_handle) {
+    if (m_Handle) {
         return E_OK;
     }
 
@@ -23,51 +23,105 @@ Result LoadLib(const char* oodle_dll_path)
         return E_OODLE_FAILED_TO_LOAD;
     }
 
-    LoadLib(handle);
-    we_looded_oodle = true;
+    const Result result = Load(handle);
+    if (result != E_OK) {
+        FreeLibrary(handle);
+        return result;
+    }
+
+    m_OwnsHandle = true;
     return E_OK;
 }
 
-Result LoadLib(void* handle)
+Result Codec::Load(void* handle)
 {
-    if (oodle_handle || !handle) {
+    if (m_Handle || !handle) {
         return E_OK;
     }
 
-    oodle_handle = handle;
-
     // load functions
-    OodleLZ_Compress   = (OodleLZ_Compress_t)GetProcAddress((HMODULE)oodle_handle, "OodleLZ_Compress");
-    OodleLZ_Decompress = (OodleLZ_Decompress_t)GetProcAddress((HMODULE)oodle_handle, "OodleLZ_Decompress");
-    if (!OodleLZ_Compress || !OodleLZ_Decompress) {
-        UnloadLib();
+    const auto compress   = (OodleLZ_Compress_t)GetProcAddress((HMODULE)handle, "OodleLZ_Compress");
+    const auto decompress = (OodleLZ_Decompress_t)GetProcAddress((HMODULE)handle, "OodleLZ_Decompress");
+    if (!compress || !decompress) {
         // throw std::runtime_error("Failed to find required functions inside Oodle DLL.");
         return E_OODLE_BAD_SIGNATURE;
     }
 
+    m_Handle     = handle;
+    m_Compress   = compress;
+    m_Decompress = decompress;
+
+    // older versions of Oodle don't export this, and will allocate decoder memory themselves
+    const auto memory_size_needed =
+        (OodleLZDecoder_MemorySizeNeeded_t)GetProcAddress((HMODULE)handle, "OodleLZDecoder_MemorySizeNeeded");
+    m_DecoderMemorySize = (memory_size_needed ? memory_size_needed(OodleLZCompresor_Invalid, -1) : 0);
     return E_OK;
 }
 
-void UnloadLib()
+void Codec::Unload()
 {
-    if (we_looded_oodle) {
-        FreeLibrary((HMODULE)oodle_handle);
-        we_looded_oodle = false;
+    if (m_OwnsHandle) {
+        FreeLibrary((HMODULE)m_Handle);
     }
 
-    oodle_handle       = nullptr;
-    OodleLZ_Compress   = nullptr;
-    OodleLZ_Decompress = nullptr;
+    m_Handle            = nullptr;
+    m_OwnsHandle        = false;
+    m_Compress          = nullptr;
+    m_Decompress        = nullptr;
+    m_DecoderMemorySize = 0;
 }
 
-int64_t Compress(const void* data, const int64_t data_size, const void* out_data)
+int64_t Codec::Compress(const void* data, const int64_t data_size, const void* out_data) const
 {
-    if (!OodleLZ_Compress) {
+    if (!m_Compress) {
         return 0;
     }
 
-    return OodleLZ_Compress(OodleLZCompresor_Kraken, data, data_size, out_data, OodleLZCompressionLevel_None, 0, 0, 0,
-                            0, 0);
+    return m_Compress(OodleLZCompresor_Kraken, data, data_size, out_data, OodleLZCompressionLevel_None, 0, 0, 0, 0, 0);
+}
+
+int64_t Codec::Decompress(const void* data, const int64_t data_size, const void* out_data, int64_t out_data_size) const
+{
+    if (!m_Decompress) {
+        return 0;
+    }
+
+    // decoder scratch memory is owned by the thread and shared by every codec, it only grows when more is needed
+    thread_local std::vector<uint8_t> decoder_memory;
+    if (m_DecoderMemorySize > 0 && decoder_memory.size() < static_cast<size_t>(m_DecoderMemorySize)) {
+        decoder_memory.resize(m_DecoderMemorySize);
+    }
+
+    void* const   memory      = (m_DecoderMemorySize > 0 ? decoder_memory.data() : nullptr);
+    const int64_t memory_size = (m_DecoderMemorySize > 0 ? static_cast<int64_t>(decoder_memory.size()) : 0);
+    return m_Decompress(data, data_size, out_data, out_data_size, 1, 0, 0, nullptr, nullptr, nullptr, nullptr, memory,
+                        memory_size, 3);
+}
+
+Codec& GetDefaultCodec()
+{
+    static Codec codec;
+    return codec;
+}
+
+Result LoadLib(const char* oodle_dll_path)
+{
+    return GetDefaultCodec().Load(oodle_dll_path);
+}
+
+Result LoadLib(void* handle)
+{
+    return GetDefaultCodec().Load(handle);
+}
+
+void UnloadLib()
+{
+    GetDefaultCodec().Unload();
+}
+
+int64_t Compress(const void* data, const int64_t data_size, const void* out_data)
+{
+    return GetDefaultCodec().Compress(data, data_size, out_data);
 }
 
 int64_t Compress(const std::vector<uint8_t>* data, std::vector<uint8_t>* out_data)
@@ -82,12 +136,7 @@ int64_t Compress(const std::vector<uint8_t>* data, std::vector<uint8_t>* out_dat
 
 int64_t Decompress(const void* data, const int64_t data_size, const void* out_data, int64_t out_data_size)
 {
-    if (!OodleLZ_Decompress) {
-        return 0;
-    }
-
-    return OodleLZ_Decompress(data, data_size, out_data, out_data_size, 1, 0, 0, nullptr, nullptr, nullptr, nullptr,
-                              nullptr, 0, 3);
+    return GetDefaultCodec().Decompress(data, data_size, out_data, out_data_size);
 }
 
 int64_t Decompress(const std::vector<uint8_t>* data, std::vector<uint8_t>* out_data)
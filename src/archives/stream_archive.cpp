@@ -6,13 +6,11 @@
 #include <util/math.h>
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <map>
-#include <numeric>
 #include <string>
 
-// TEMP
-#include <fstream>
-
 namespace ava::StreamArchive
 {
 Result Parse(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* out_entries)
@@ -110,6 +108,122 @@ Result Parse(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* out_
     return E_OK;
 }
 
+Result Parse(const uint8_t* buffer, const size_t buffer_size, std::vector<ArchiveEntryView>* out_entries)
+{
+    if (!buffer || buffer_size == 0 || !out_entries) {
+        // throw std::invalid_argument("SARC input buffer can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    // read header
+    SarcHeader header{};
+    if (buffer_size < sizeof(SarcHeader)) {
+        // throw std::runtime_error("Invalid SARC header magic!");
+        return E_SARC_INVALID_MAGIC;
+    }
+
+    std::memcpy(&header, buffer, sizeof(SarcHeader));
+    if (header.m_Magic != SARC_MAGIC) {
+        // throw std::runtime_error("Invalid SARC header magic!");
+        return E_SARC_INVALID_MAGIC;
+    }
+
+    // the entry headers sit between the SARC header and the first entry buffer
+    if (header.m_Size > (buffer_size - sizeof(SarcHeader))) {
+        // throw std::runtime_error("SARC header is larger than the input buffer!");
+        return E_SARC_ENTRY_OUT_OF_BOUNDS;
+    }
+
+    const uint8_t* ptr = (buffer + sizeof(SarcHeader));
+    const uint8_t* end = (ptr + header.m_Size);
+
+    switch (header.m_Version) {
+        case 2: {
+            // every entry is at least a filename length, offset and size, anything smaller is padding
+            while ((end - ptr) > 15) {
+                uint32_t length = 0;
+                std::memcpy(&length, ptr, sizeof(uint32_t));
+                ptr += sizeof(uint32_t);
+
+                if (length > static_cast<size_t>((end - ptr) - (sizeof(uint32_t) * 2))) {
+                    // throw std::runtime_error("SARC entry filename is out of bounds!");
+                    return E_SARC_ENTRY_OUT_OF_BOUNDS;
+                }
+
+                // filenames are padded with null bytes
+                const char* filename = (const char*)ptr;
+                const auto  length_without_padding =
+                    static_cast<size_t>(std::find(filename, filename + length, '\0') - filename);
+                ptr += length;
+
+                ArchiveEntryView entry{};
+                entry.m_Filename = std::string_view(filename, length_without_padding);
+                entry.m_NameHash = ava::hashlittle(filename, length_without_padding);
+                std::memcpy(&entry.m_Offset, ptr, sizeof(uint32_t));
+                std::memcpy(&entry.m_Size, ptr + sizeof(uint32_t), sizeof(uint32_t));
+                ptr += (sizeof(uint32_t) * 2);
+
+                out_entries->push_back(entry);
+            }
+
+            break;
+        }
+
+        case 3: {
+            uint32_t strings_length = 0;
+            if (static_cast<size_t>(end - ptr) < sizeof(uint32_t)) {
+                // throw std::runtime_error("SARC string table is out of bounds!");
+                return E_SARC_ENTRY_OUT_OF_BOUNDS;
+            }
+
+            std::memcpy(&strings_length, ptr, sizeof(uint32_t));
+            ptr += sizeof(uint32_t);
+
+            if (strings_length > static_cast<size_t>(end - ptr)) {
+                // throw std::runtime_error("SARC string table is out of bounds!");
+                return E_SARC_ENTRY_OUT_OF_BOUNDS;
+            }
+
+            const char* strings     = (const char*)ptr;
+            const char* strings_end = (strings + strings_length);
+            ptr += strings_length;
+
+            // read all entries, the filename is found from the entry name offset into the string table
+            const size_t num_entries = (static_cast<size_t>(end - ptr) / sizeof(SarcEntryV3));
+            out_entries->reserve(out_entries->size() + num_entries);
+            for (size_t i = 0; i < num_entries; ++i) {
+                SarcEntryV3 sarc_entry;
+                std::memcpy(&sarc_entry, ptr, sizeof(SarcEntryV3));
+                ptr += sizeof(SarcEntryV3);
+
+                if (sarc_entry.m_NameOffset >= strings_length) {
+                    // throw std::runtime_error("SARC entry filename is out of bounds!");
+                    return E_SARC_ENTRY_OUT_OF_BOUNDS;
+                }
+
+                const char* filename = (strings + sarc_entry.m_NameOffset);
+                const auto  length   = static_cast<size_t>(std::find(filename, strings_end, '\0') - filename);
+
+                ArchiveEntryView entry{};
+                entry.m_Filename = std::string_view(filename, length);
+                entry.m_NameHash = sarc_entry.m_NameHash;
+                entry.m_Offset   = sarc_entry.m_Offset;
+                entry.m_Size     = sarc_entry.m_Size;
+                out_entries->push_back(entry);
+            }
+
+            break;
+        }
+
+        default: {
+            // throw std::runtime_error("Unknown SARC version!");
+            return E_SARC_UNKNOWN_VERSION;
+        }
+    }
+
+    return E_OK;
+}
+
 Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* out_entries)
 {
     if (buffer.empty() || !out_entries) {
@@ -142,6 +256,77 @@ Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* o
     return E_OK;
 }
 
+// merge a TOC file list into entries, index maps the entry name hashes to their position in entries
+static Result MergeTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* entries, utils::HashIndex* index,
+                       uint32_t* total_added, uint32_t* total_patched)
+{
+    const uint8_t* ptr = buffer.data();
+    const uint8_t* end = (ptr + buffer.size());
+
+    // read entries
+    while (ptr < end) {
+        uint32_t length = 0;
+        if (static_cast<size_t>(end - ptr) < sizeof(uint32_t)) {
+            return E_SARC_ENTRY_OUT_OF_BOUNDS;
+        }
+
+        std::memcpy(&length, ptr, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+
+        if (static_cast<size_t>(end - ptr) < (static_cast<size_t>(length) + (sizeof(uint32_t) * 2))) {
+            return E_SARC_ENTRY_OUT_OF_BOUNDS;
+        }
+
+        // filenames are not null terminated, but stop at a null byte like the string based parser
+        const char* filename = (const char*)ptr;
+        const auto  filename_length =
+            static_cast<size_t>(std::find(filename, filename + length, '\0') - filename);
+        ptr += length;
+
+        uint32_t offset = 0;
+        uint32_t size   = 0;
+        std::memcpy(&offset, ptr, sizeof(uint32_t));
+        std::memcpy(&size, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        ptr += (sizeof(uint32_t) * 2);
+
+        const uint32_t name_hash = ava::hashlittle(filename, filename_length);
+        const uint32_t position  = index->find(name_hash);
+        if (position == utils::HashIndex::INVALID_VALUE) {
+            ArchiveEntry entry{};
+            entry.m_Filename = std::string(filename, filename_length);
+            entry.m_NameHash = name_hash;
+            entry.m_Offset   = offset;
+            entry.m_Size     = size;
+
+            index->insert(name_hash, static_cast<uint32_t>(entries->size()));
+            entries->emplace_back(std::move(entry));
+            ++(*total_added);
+        } else {
+            auto& it_entry = (*entries)[position];
+
+            if ((it_entry.m_Offset != offset || it_entry.m_Size != size)) {
+                ++(*total_patched);
+            }
+
+            it_entry.m_Offset = offset;
+            it_entry.m_Size   = size;
+        }
+    }
+
+    return E_OK;
+}
+
+static utils::HashIndex BuildEntryIndex(const std::vector<ArchiveEntry>& entries)
+{
+    // if a name hash appears more than once, the first entry is used
+    utils::HashIndex index(entries.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(entries.size()); ++i) {
+        index.insert(entries[i].m_NameHash, i);
+    }
+
+    return index;
+}
+
 Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* entries, uint32_t* out_total_added,
                 uint32_t* out_total_patched)
 {
@@ -150,43 +335,44 @@ Result ParseTOC(const std::vector<uint8_t>& buffer, std::vector<ArchiveEntry>* e
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
-    std::istream      stream(&buf);
-
     uint32_t total_added   = 0;
     uint32_t total_patched = 0;
 
-    // read entries
-    while (static_cast<size_t>(stream.tellg()) < buffer.size()) {
-        uint32_t length;
-        stream.read((char*)&length, sizeof(uint32_t));
+    utils::HashIndex index  = BuildEntryIndex(*entries);
+    const Result     result = MergeTOC(buffer, entries, &index, &total_added, &total_patched);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
 
-        // read the filename string
-        const auto filename = std::unique_ptr<char[]>(new char[length + 1]);
-        stream.read(filename.get(), length);
-        filename[length] = '\0';
+    if (out_total_added) {
+        *out_total_added = total_added;
+    }
 
-        // read archive entry
-        ArchiveEntry entry{};
-        entry.m_Filename = filename.get();
-        entry.m_NameHash = ava::hashlittle(entry.m_Filename.c_str());
-        stream.read((char*)&entry.m_Offset, sizeof(entry.m_Offset));
-        stream.read((char*)&entry.m_Size, sizeof(entry.m_Size));
+    if (out_total_patched) {
+        *out_total_patched = total_patched;
+    }
 
-        const auto it = std::find_if(entries->begin(), entries->end(),
-                                     [&](const ArchiveEntry& item) { return item.m_NameHash == entry.m_NameHash; });
-        if (it == entries->end()) {
-            entries->emplace_back(std::move(entry));
-            ++total_added;
-        } else {
-            auto& it_entry = (*it);
+    return E_OK;
+}
 
-            if ((it_entry.m_Offset != entry.m_Offset || it_entry.m_Size != entry.m_Size)) {
-                ++total_patched;
-            }
+Result ParseTOC(const std::vector<const std::vector<uint8_t>*>& buffers, std::vector<ArchiveEntry>* entries,
+                uint32_t* out_total_added, uint32_t* out_total_patched)
+{
+    const auto is_empty = [](const std::vector<uint8_t>* buffer) { return !buffer || buffer->empty(); };
+    if (buffers.empty() || std::any_of(buffers.begin(), buffers.end(), is_empty) || !entries) {
+        // throw std::invalid_argument("SARC TOC input buffer can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
 
-            it_entry.m_Offset = entry.m_Offset;
-            it_entry.m_Size   = entry.m_Size;
+    uint32_t total_added   = 0;
+    uint32_t total_patched = 0;
+
+    // the index is built once, and kept up to date as entries are added by each layer
+    utils::HashIndex index = BuildEntryIndex(*entries);
+    for (const auto* buffer : buffers) {
+        const Result result = MergeTOC(*buffer, entries, &index, &total_added, &total_patched);
+        if (AVA_FL_FAILED(result)) {
+            return result;
         }
     }
 
@@ -221,9 +407,11 @@ Result InitBuffer(std::vector<uint8_t>* buffer, const uint32_t version)
     return E_OK;
 }
 
-Result ReadEntry(const std::vector<uint8_t>& buffer, const ArchiveEntry& entry, std::vector<uint8_t>* out_buffer)
+template <typename T>
+static Result GetEntryData(const uint8_t* buffer, const size_t buffer_size, const T& entry, const uint8_t** out_data,
+                           uint32_t* out_size)
 {
-    if (buffer.empty() || !out_buffer) {
+    if (!buffer || buffer_size == 0 || !out_data || !out_size) {
         return E_INVALID_ARGUMENT;
     }
 
@@ -232,12 +420,41 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const ArchiveEntry& entry,
         return E_SARC_PATCHED_ENTRY;
     }
 
-    // @TODO: Fix reading entries which are patched (offset == 0).
-    // assert(entry.m_Offset != 0 && entry.m_Offset != -1);
-    assert((entry.m_Offset + entry.m_Size) <= buffer.size());
+    if ((static_cast<uint64_t>(entry.m_Offset) + entry.m_Size) > buffer_size) {
+        return E_SARC_ENTRY_OUT_OF_BOUNDS;
+    }
 
-    const auto start = buffer.begin() + entry.m_Offset;
-    std::copy(start, start + entry.m_Size, std::back_inserter(*out_buffer));
+    *out_data = (buffer + entry.m_Offset);
+    *out_size = entry.m_Size;
+    return E_OK;
+}
+
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const ArchiveEntry& entry, const uint8_t** out_data,
+                 uint32_t* out_size)
+{
+    return GetEntryData(buffer, buffer_size, entry, out_data, out_size);
+}
+
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const ArchiveEntryView& entry,
+                 const uint8_t** out_data, uint32_t* out_size)
+{
+    return GetEntryData(buffer, buffer_size, entry, out_data, out_size);
+}
+
+Result ReadEntry(const std::vector<uint8_t>& buffer, const ArchiveEntry& entry, std::vector<uint8_t>* out_buffer)
+{
+    if (buffer.empty() || !out_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const uint8_t* data   = nullptr;
+    uint32_t       size   = 0;
+    const Result   result = GetEntryData(buffer.data(), buffer.size(), entry, &data, &size);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    out_buffer->insert(out_buffer->end(), data, data + size);
     return E_OK;
 }
 
@@ -257,18 +474,7 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const std::vector<ArchiveEn
         return E_SARC_UNKNOWN_ENTRY;
     }
 
-    const ArchiveEntry& entry = (*it);
-
-    // entry does not exist in this archive (patched)
-    if (entry.m_Offset == 0 || entry.m_Offset == -1) {
-        return E_SARC_PATCHED_ENTRY;
-    }
-
-    assert((entry.m_Offset + entry.m_Size) <= buffer.size());
-
-    const auto start = buffer.begin() + entry.m_Offset;
-    std::copy(start, start + entry.m_Size, std::back_inserter(*out_buffer));
-    return E_OK;
+    return ReadEntry(buffer, *it, out_buffer);
 }
 
 Result WriteEntry(std::vector<uint8_t>* buffer, std::vector<ArchiveEntry>* entries, const std::string& filename,
@@ -279,136 +485,49 @@ Result WriteEntry(std::vector<uint8_t>* buffer, std::vector<ArchiveEntry>* entri
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(*buffer);
-    std::istream      stream(&buf);
-
-    // read header if the buffer isn't empty
+    // read header
     SarcHeader header{};
-    stream.read((char*)&header, sizeof(SarcHeader));
+    if (buffer->size() >= sizeof(SarcHeader)) {
+        std::memcpy(&header, buffer->data(), sizeof(SarcHeader));
+    }
+
     if (header.m_Magic != SARC_MAGIC) {
         // throw std::runtime_error("Invalid SARC header magic!");
         return E_SARC_INVALID_MAGIC;
     }
 
-    std::vector<uint8_t>    temp_buffer;
-    utils::ByteVectorStream tbuf(&temp_buffer);
-
-    const uint32_t filename_hash = ava::hashlittle(filename.c_str());
-
-    ArchiveEntry* entry = nullptr;
-    const auto    it    = std::find_if(entries->begin(), entries->end(), [filename_hash](const ArchiveEntry& item) {
-        return item.m_NameHash == filename_hash;
-    });
-
-    // file currently does not exist in the archive, add a new entry
-    if (it == entries->end()) {
-        ArchiveEntry e{};
-        e.m_Filename = filename;
-        e.m_NameHash = filename_hash;
-        e.m_Offset   = 1; // @NOTE: offset will be updated later, just make sure this is >0
-        e.m_Size     = static_cast<uint32_t>(file_buffer.size());
-        entries->emplace_back(std::move(e));
-
-        entry = &entries->back();
-    }
-    // file already exists in the archive, update the size
-    else {
-        entry         = &(*it);
-        entry->m_Size = static_cast<uint32_t>(file_buffer.size());
-
-        // file exists in archive, but was patched, we should write a new data offset!
-        if (entry->m_Offset == 0 || entry->m_Offset == -1) {
-            entry->m_Offset = 1; // @NOTE: will be generated later!
-        }
-    }
-
     if (header.m_Version < 2 || header.m_Version > 3) {
         // throw std::runtime_error("Invalid SARC header version!");
         return E_SARC_UNKNOWN_VERSION;
     }
 
-    switch (header.m_Version) {
-        case 2: {
-            // calculate new header and data size
-            uint32_t header_size = 0;
-            uint32_t data_size   = 0;
-            for (const auto& entry : *entries) {
-                const uint32_t length            = ava::math::aligned_string_len(entry.m_Filename);
-                const uint32_t entry_header_size = sizeof(uint32_t) + length + sizeof(uint32_t) + sizeof(uint32_t);
-                const uint32_t entry_data_size   = (entry.m_Offset != 0 && entry.m_Offset != -1) ? entry.m_Size : 0;
-
-                header_size += entry_header_size;
-                data_size += ava::math::align(entry_data_size);
-            }
-
-            header.m_Size = ava::math::align(header_size, 16);
-
-            // allocate enough space for everything
-            temp_buffer.resize(sizeof(SarcHeader) + header.m_Size + data_size);
-            tbuf.write(header);
-
-            // update all entries
-            uint32_t current_data_offset = (sizeof(SarcHeader) + header.m_Size);
-            for (auto& entry : *entries) {
-                uint32_t       padding = 0;
-                const uint32_t length  = ava::math::aligned_string_len(entry.m_Filename, sizeof(uint32_t), &padding);
-                const bool     exists_in_sarc = (entry.m_Offset != 0 && entry.m_Offset != -1);
-                const uint32_t data_offset    = exists_in_sarc ? current_data_offset : entry.m_Offset;
-
-                tbuf.write(length);
-                tbuf.write((char*)entry.m_Filename.c_str(), entry.m_Filename.length());
-                tbuf.write((char*)&SARC_ENTRY_PADDING_BYTE, sizeof(uint8_t), padding);
-                tbuf.write(data_offset);
-                tbuf.write(entry.m_Size);
-
-                // only update offsets of non-patched files
-                if (exists_in_sarc) {
-                    // if the current entry is the file we added, copy the buffer from the input file buffer
-                    if (entry.m_NameHash == filename_hash) {
-                        std::memcpy(&temp_buffer[data_offset], file_buffer.data(), file_buffer.size());
-                    } else {
-                        std::memcpy(&temp_buffer[data_offset], &(*buffer)[entry.m_Offset], entry.m_Size);
-                    }
-
-                    // update the entry data offset
-                    entry.m_Offset = data_offset;
-                }
-
-                // update the current data offset
-                current_data_offset = ava::math::align(current_data_offset + (exists_in_sarc ? entry.m_Size : 0));
-            }
-
-            *buffer = std::move(temp_buffer);
-            break;
+    // rebuild the archive with the current entries, and the new file buffer
+    ArchiveBuilder builder(header.m_Version);
+    for (const auto& entry : *entries) {
+        // entry does not exist in this archive (patched), keep its offset so TOC only entries stay -1
+        if (entry.m_Offset == 0 || entry.m_Offset == -1) {
+            builder.AddPatchedEntry(entry.m_Filename, entry.m_Size, entry.m_Offset);
+            continue;
         }
 
-        case 3: {
-            // calculate strings length
-            const uint32_t strings_length = std::accumulate(
-                entries->begin(), entries->end(), 0, [](uint32_t accumulator, const ArchiveEntry& entry) {
-                    return accumulator + (uint32_t)entry.m_Filename.length() + 1;
-                });
-
-            tbuf.write(strings_length);
-
-            // write strings
-            for (const auto& entry : *entries) {
-                tbuf.write((char*)entry.m_Filename.c_str(), entry.m_Filename.length() + 1);
-            }
+        if ((static_cast<uint64_t>(entry.m_Offset) + entry.m_Size) > buffer->size()) {
+            return E_SARC_ENTRY_OUT_OF_BOUNDS;
+        }
 
-            // @TODO: finish me!
+        const auto start = buffer->begin() + entry.m_Offset;
+        builder.AddEntry(entry.m_Filename, std::vector<uint8_t>(start, start + entry.m_Size));
+    }
 
-#ifdef _DEBUG
-            std::ofstream s("c:/users/aaron/desktop/tmp.bin", std::ios::binary);
-            s.write((char*)temp_buffer.data(), temp_buffer.size());
-            s.close();
+    builder.AddEntry(filename, file_buffer);
 
-            __debugbreak();
-#endif
-            break;
-        }
+    std::vector<uint8_t> temp_buffer;
+    const Result         result = builder.Write(&temp_buffer);
+    if (AVA_FL_FAILED(result)) {
+        return result;
     }
 
+    *buffer  = std::move(temp_buffer);
+    *entries = builder.GetEntries();
     return E_OK;
 }
 
@@ -432,4 +551,244 @@ Result WriteTOC(std::vector<uint8_t>* buffer, const std::vector<ArchiveEntry>& e
 
     return E_OK;
 }
+
+static uint32_t GetExtensionHash(const std::string& filename)
+{
+    const auto pos = filename.find_last_of("./");
+    if (pos == std::string::npos || filename[pos] != '.') {
+        return 0;
+    }
+
+    return ava::hashlittle(filename.c_str() + pos);
+}
+
+Result ArchiveBuilder::AddEntry(const std::string& filename, std::vector<uint8_t> file_buffer)
+{
+    if (filename.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const uint32_t size = static_cast<uint32_t>(file_buffer.size());
+    InsertEntry(filename, size, {std::move(file_buffer), false});
+    return E_OK;
+}
+
+Result ArchiveBuilder::AddPatchedEntry(const std::string& filename, const uint32_t size, const uint32_t offset)
+{
+    if (filename.empty()) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    InsertEntry(filename, size, {{}, true, offset});
+    return E_OK;
+}
+
+void ArchiveBuilder::InsertEntry(const std::string& filename, const uint32_t size, EntryBuffer&& buffer)
+{
+    ArchiveEntry entry{};
+    entry.m_Filename = filename;
+    entry.m_NameHash = ava::hashlittle(filename.c_str());
+    entry.m_Size     = size;
+
+    // replace the entry if it was already added
+    const uint32_t index = m_Index.find(entry.m_NameHash);
+    if (index != utils::HashIndex::INVALID_VALUE) {
+        m_Entries[index] = std::move(entry);
+        m_Buffers[index] = std::move(buffer);
+        return;
+    }
+
+    m_Index.insert(entry.m_NameHash, static_cast<uint32_t>(m_Entries.size()));
+    m_Entries.emplace_back(std::move(entry));
+    m_Buffers.emplace_back(std::move(buffer));
+}
+
+Result ArchiveBuilder::WriteHeaders(std::vector<uint8_t>* out_buffer, uint64_t* out_total_size)
+{
+    if (m_Version < 2 || m_Version > 3) {
+        // throw std::runtime_error("Invalid SARC header version! (only v2 and v3 are supported)");
+        return E_SARC_UNKNOWN_VERSION;
+    }
+
+    // calculate the entry headers size
+    uint64_t headers_size   = 0;
+    uint32_t strings_length = 0;
+    if (m_Version == 2) {
+        for (const auto& entry : m_Entries) {
+            headers_size += (sizeof(uint32_t) + ava::math::aligned_string_len(entry.m_Filename) + sizeof(uint32_t)
+                             + sizeof(uint32_t));
+        }
+    } else {
+        for (const auto& entry : m_Entries) {
+            strings_length += static_cast<uint32_t>(entry.m_Filename.length() + 1);
+        }
+
+        headers_size = (sizeof(uint32_t) + strings_length + (sizeof(SarcEntryV3) * m_Entries.size()));
+    }
+
+    SarcHeader header;
+    header.m_Version = m_Version;
+    header.m_Size    = static_cast<uint32_t>(ava::math::align<uint64_t>(headers_size, 16));
+
+    // lay out the entry buffers, patched entries don't have a buffer in this archive
+    uint64_t data_offset = (sizeof(SarcHeader) + ava::math::align<uint64_t>(headers_size, 16));
+    for (size_t i = 0; i < m_Entries.size(); ++i) {
+        if (m_Buffers[i].m_Patched) {
+            m_Entries[i].m_Offset = m_Buffers[i].m_PatchedOffset;
+            continue;
+        }
+
+        m_Entries[i].m_Offset = static_cast<uint32_t>(data_offset);
+        data_offset           = ava::math::align<uint64_t>(data_offset + m_Entries[i].m_Size);
+    }
+
+    if (data_offset > UINT32_MAX) {
+        // throw std::runtime_error("SARC is too large!");
+        return E_SARC_ENTRY_OUT_OF_BOUNDS;
+    }
+
+    out_buffer->reserve(sizeof(SarcHeader) + header.m_Size);
+    utils::ByteVectorStream buf(out_buffer);
+    buf.write(header);
+
+    if (m_Version == 2) {
+        for (const auto& entry : m_Entries) {
+            uint32_t       padding = 0;
+            const uint32_t length  = ava::math::aligned_string_len(entry.m_Filename, sizeof(uint32_t), &padding);
+
+            buf.write(length);
+            buf.write(entry.m_Filename.c_str(), entry.m_Filename.length());
+            buf.write((char*)&SARC_ENTRY_PADDING_BYTE, sizeof(uint8_t), padding);
+            buf.write(entry.m_Offset);
+            buf.write(entry.m_Size);
+        }
+    } else {
+        buf.write(strings_length);
+        for (const auto& entry : m_Entries) {
+            buf.write(entry.m_Filename.c_str(), entry.m_Filename.length() + 1);
+        }
+
+        uint32_t name_offset = 0;
+        for (const auto& entry : m_Entries) {
+            SarcEntryV3 sarc_entry{};
+            sarc_entry.m_NameOffset    = name_offset;
+            sarc_entry.m_Offset        = entry.m_Offset;
+            sarc_entry.m_Size          = entry.m_Size;
+            sarc_entry.m_NameHash      = entry.m_NameHash;
+            sarc_entry.m_ExtensionHash = GetExtensionHash(entry.m_Filename);
+            buf.write(sarc_entry);
+
+            name_offset += static_cast<uint32_t>(entry.m_Filename.length() + 1);
+        }
+    }
+
+    // pad the entry headers
+    buf.write((char*)&SARC_ENTRY_PADDING_BYTE, sizeof(uint8_t), (sizeof(SarcHeader) + header.m_Size) - buf.tellp());
+
+    *out_total_size = data_offset;
+    return E_OK;
+}
+
+Result ArchiveBuilder::Write(std::vector<uint8_t>* out_buffer)
+{
+    if (!out_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    out_buffer->clear();
+
+    uint64_t     total_size = 0;
+    const Result result     = WriteHeaders(out_buffer, &total_size);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    // padding between the entry buffers is zero initialised by the resize
+    out_buffer->resize(total_size);
+    for (size_t i = 0; i < m_Entries.size(); ++i) {
+        const auto& buffer = m_Buffers[i].m_Buffer;
+        if (!m_Buffers[i].m_Patched && !buffer.empty()) {
+            std::memcpy(out_buffer->data() + m_Entries[i].m_Offset, buffer.data(), buffer.size());
+        }
+    }
+
+    return E_OK;
+}
+
+Result ArchiveBuilder::Write(std::ostream& stream)
+{
+    std::vector<uint8_t> headers;
+    uint64_t             total_size = 0;
+
+    const Result result = WriteHeaders(&headers, &total_size);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    stream.write((const char*)headers.data(), headers.size());
+
+    static const char zeros[sizeof(uint32_t)] = {0};
+    uint64_t          position                = headers.size();
+    for (size_t i = 0; i < m_Entries.size(); ++i) {
+        if (m_Buffers[i].m_Patched) {
+            continue;
+        }
+
+        const auto& buffer = m_Buffers[i].m_Buffer;
+        stream.write(zeros, (m_Entries[i].m_Offset - position));
+        stream.write((const char*)buffer.data(), buffer.size());
+        position = (static_cast<uint64_t>(m_Entries[i].m_Offset) + buffer.size());
+    }
+
+    stream.write(zeros, (total_size - position));
+    return stream.fail() ? E_FAILED_TO_WRITE_FILE : E_OK;
+}
+
+Result ArchiveBuilder::Write(const std::filesystem::path& filename)
+{
+    std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+    if (stream.fail()) {
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    return Write(stream);
+}
+
+void EntryIndex::Build(std::vector<ArchiveEntry> entries)
+{
+    m_Entries = std::move(entries);
+    m_Index   = BuildEntryIndex(m_Entries);
+}
+
+const ArchiveEntry* EntryIndex::Find(const std::string_view filename) const
+{
+    return Find(ava::hashlittle(filename.data(), filename.length()));
+}
+
+Result EntryIndex::ReadEntry(const std::vector<uint8_t>& buffer, const uint32_t name_hash,
+                             std::vector<uint8_t>* out_buffer) const
+{
+    if (buffer.empty() || !out_buffer) {
+        return E_INVALID_ARGUMENT;
+    }
+
+    const ArchiveEntry* entry = Find(name_hash);
+    if (!entry) {
+        return E_SARC_UNKNOWN_ENTRY;
+    }
+
+    return ava::StreamArchive::ReadEntry(buffer, *entry, out_buffer);
+}
+
+Result EntryIndex::ReadEntry(const std::vector<uint8_t>& buffer, const std::string_view filename,
+                             std::vector<uint8_t>* out_buffer) const
+{
+    return ReadEntry(buffer, ava::hashlittle(filename.data(), filename.length()), out_buffer);
+}
+
+void EntryIndex::Clear()
+{
+    m_Entries.clear();
+    m_Index.clear();
+}
 }; // namespace ava::StreamArchive
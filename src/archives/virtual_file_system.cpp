@@ -0,0 +1,443 @@
+#include <archives/avalanche_archive_format.h>
+#include <archives/virtual_file_system.h>
+#include <legacy/archive_table.h>
+
+#include <util/hashlittle.h>
+
+#include <assert.h>
+
+namespace ava::VirtualFileSystem
+{
+Result FileSystem::Mount(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename,
+                         const int32_t priority, uint32_t* out_mount_index)
+{
+    MountedArchive mount;
+    mount.m_Filename = arc_filename;
+    mount.m_Priority = priority;
+
+    const Result result = mount.m_Archive.Open(tab_filename, arc_filename);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    AddMount(std::move(mount), out_mount_index);
+    return E_OK;
+}
+
+Result FileSystem::MountLegacy(const std::filesystem::path& tab_filename, const std::filesystem::path& arc_filename,
+                               const int32_t priority, uint32_t* out_mount_index)
+{
+    namespace LegacyArchiveTable = ava::legacy::ArchiveTable;
+
+    MountedArchive mount;
+    mount.m_Filename = arc_filename;
+    mount.m_Priority = priority;
+    mount.m_Legacy   = true;
+
+    utils::MemoryMappedFile tab_file;
+    if (!tab_file.open(tab_filename) || !mount.m_LegacyArcFile.open(arc_filename)) {
+        // throw std::runtime_error("failed to open legacy TAB/ARC file!");
+        return E_FAILED_TO_OPEN_FILE;
+    }
+
+    std::vector<LegacyArchiveTable::TabEntry> legacy_entries;
+    {
+        // the TAB file is small, and the legacy parser wants a buffer it can stream from
+        const std::vector<uint8_t> tab_buffer(tab_file.data(), tab_file.data() + tab_file.size());
+
+        const Result result = LegacyArchiveTable::Parse(tab_buffer, &legacy_entries);
+        if (AVA_FL_FAILED(result)) {
+            return result;
+        }
+    }
+
+    // legacy entries are never compressed, so they are stored as uncompressed entries and read like any other mount
+    mount.m_LegacyEntries.reserve(legacy_entries.size());
+    for (const auto& legacy_entry : legacy_entries) {
+        ava::ArchiveTable::TabEntry entry{};
+        entry.m_NameHash         = legacy_entry.m_NameHash;
+        entry.m_Offset           = legacy_entry.m_Offset;
+        entry.m_Size             = legacy_entry.m_Size;
+        entry.m_UncompressedSize = legacy_entry.m_Size;
+        entry.m_Library          = ava::ArchiveTable::E_COMPRESS_LIBRARY_NONE;
+        mount.m_LegacyEntries.push_back(entry);
+    }
+
+    AddMount(std::move(mount), out_mount_index);
+    return E_OK;
+}
+
+void FileSystem::AddMount(MountedArchive&& mount, uint32_t* out_mount_index)
+{
+    const uint32_t mount_index = static_cast<uint32_t>(m_Mounts.size());
+    const auto&    entries     = mount.GetEntries();
+
+    m_Index.reserve(m_Index.size() + entries.size());
+    m_Locations.reserve(m_Locations.size() + entries.size());
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(entries.size()); ++i) {
+        const uint32_t name_hash = entries[i].m_NameHash;
+        const uint32_t location  = m_Index.find(name_hash);
+
+        if (location == utils::HashIndex::INVALID_VALUE) {
+            m_Index.insert(name_hash, static_cast<uint32_t>(m_Locations.size()));
+            m_Locations.push_back({mount_index, i});
+            continue;
+        }
+
+        // the first entry of a duplicated name hash inside one archive wins, otherwise later mounts win ties
+        EntryLocation& existing = m_Locations[location];
+        if (existing.m_MountIndex != mount_index && mount.m_Priority >= m_Mounts[existing.m_MountIndex].m_Priority) {
+            existing.m_MountIndex = mount_index;
+            existing.m_EntryIndex = i;
+        }
+    }
+
+    m_Mounts.emplace_back(std::move(mount));
+
+    if (out_mount_index) {
+        *out_mount_index = mount_index;
+    }
+}
+
+void FileSystem::Clear()
+{
+    m_Mounts.clear();
+    m_Locations.clear();
+    m_Index.clear();
+}
+
+const ava::ArchiveTable::TabEntry* FileSystem::Find(const uint32_t name_hash, uint32_t* out_mount_index) const
+{
+    const uint32_t location = m_Index.find(name_hash);
+    if (location == utils::HashIndex::INVALID_VALUE) {
+        if (out_mount_index) {
+            *out_mount_index = INVALID_MOUNT;
+        }
+
+        return nullptr;
+    }
+
+    const EntryLocation& entry_location = m_Locations[location];
+    if (out_mount_index) {
+        *out_mount_index = entry_location.m_MountIndex;
+    }
+
+    return &m_Mounts[entry_location.m_MountIndex].GetEntries()[entry_location.m_EntryIndex];
+}
+
+Result FileSystem::ReadEntry(const uint32_t name_hash, ava::ArchiveTable::TabEntry* out_entry,
+                             uint32_t* out_mount_index) const
+{
+    if (!out_entry) {
+        // throw std::invalid_argument("output entry can't be nullptr!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    const auto entry = Find(name_hash, out_mount_index);
+    if (!entry) {
+        // throw std::runtime_error("entry was not found in any mounted archive!");
+        return E_TAB_UNKNOWN_ENTRY;
+    }
+
+    *out_entry = (*entry);
+    return E_OK;
+}
+
+Result FileSystem::ReadEntryBuffer(const uint32_t name_hash, std::vector<uint8_t>* out_buffer) const
+{
+    if (!out_buffer) {
+        // throw std::invalid_argument("output buffer can't be nullptr!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    uint32_t   mount_index = INVALID_MOUNT;
+    const auto entry       = Find(name_hash, &mount_index);
+    if (!entry) {
+        // throw std::runtime_error("entry was not found in any mounted archive!");
+        return E_TAB_UNKNOWN_ENTRY;
+    }
+
+    const MountedArchive& mount = m_Mounts[mount_index];
+    if (!mount.m_Legacy) {
+        return mount.m_Archive.ReadEntryBuffer(*entry, out_buffer);
+    }
+
+    out_buffer->resize(entry->m_Size);
+
+    const Result result =
+        ava::ArchiveTable::ReadEntryBuffer(mount.m_LegacyArcFile.data(), mount.m_LegacyArcFile.size(), *entry,
+                                           out_buffer->data(), out_buffer->size());
+    if (AVA_FL_FAILED(result)) {
+        out_buffer->clear();
+    }
+
+    return result;
+}
+
+Result FileSystem::ReadEntryBuffer(const std::string& filename, std::vector<uint8_t>* out_buffer) const
+{
+    return ReadEntryBuffer(ava::hashlittle(filename.c_str()), out_buffer);
+}
+
+int32_t FileSystem::GetMountPriority(const uint32_t mount_index) const
+{
+    assert(mount_index < m_Mounts.size());
+    return m_Mounts[mount_index].m_Priority;
+}
+
+const std::filesystem::path& FileSystem::GetMountFilename(const uint32_t mount_index) const
+{
+    assert(mount_index < m_Mounts.size());
+    return m_Mounts[mount_index].m_Filename;
+}
+
+static uint32_t HashName(const std::string_view name)
+{
+    return ava::hashlittle(name.data(), name.size());
+}
+
+const StreamArchive::ArchiveEntryView* PathResolver::Container::Find(const uint32_t name_hash) const
+{
+    const uint32_t index = m_Index.find(name_hash);
+    return (index != utils::HashIndex::INVALID_VALUE) ? &m_Entries[index] : nullptr;
+}
+
+Result PathResolver::Resolve(const std::string_view path, ResolvedBuffer* out_buffer)
+{
+    if (path.empty() || !out_buffer) {
+        // throw std::invalid_argument("path can't be empty!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    // nullptr is the root layer (the file system)
+    ContainerPtr container = nullptr;
+    size_t       start     = 0;
+
+    while (true) {
+        const std::string_view remaining = path.substr(start);
+        if (Contains(container.get(), remaining)) {
+            return ReadLayer(container.get(), remaining, out_buffer);
+        }
+
+        // the shortest prefix which is an entry of the current layer is the next container
+        bool found = false;
+        for (size_t sep = remaining.find('/'); sep != std::string_view::npos; sep = remaining.find('/', sep + 1)) {
+            const std::string_view name = remaining.substr(0, sep);
+            if (!Contains(container.get(), name)) {
+                continue;
+            }
+
+            ContainerPtr next;
+            const Result result = GetContainer(container.get(), path.substr(0, start + sep), name, &next);
+            if (AVA_FL_FAILED(result)) {
+                return result;
+            }
+
+            container = std::move(next);
+            start += (sep + 1);
+            found = true;
+            break;
+        }
+
+        if (!found) {
+            // throw std::runtime_error("path was not found!");
+            return container ? E_SARC_UNKNOWN_ENTRY : E_TAB_UNKNOWN_ENTRY;
+        }
+    }
+}
+
+Result PathResolver::Resolve(const std::string_view path, std::vector<uint8_t>* out_buffer)
+{
+    if (!out_buffer) {
+        // throw std::invalid_argument("output buffer can't be nullptr!");
+        return E_INVALID_ARGUMENT;
+    }
+
+    ResolvedBuffer buffer;
+    const Result   result = Resolve(path, &buffer);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    out_buffer->assign(buffer.m_Data, buffer.m_Data + buffer.m_Size);
+    return E_OK;
+}
+
+bool PathResolver::Contains(const Container* container, const std::string_view name) const
+{
+    const uint32_t name_hash = HashName(name);
+    return container ? (container->Find(name_hash) != nullptr) : m_FileSystem.Contains(name_hash);
+}
+
+Result PathResolver::ReadLayer(const Container* container, const std::string_view name,
+                               ResolvedBuffer* out_buffer) const
+{
+    const uint32_t name_hash = HashName(name);
+
+    if (!container) {
+        auto         buffer = std::make_shared<std::vector<uint8_t>>();
+        const Result result = m_FileSystem.ReadEntryBuffer(name_hash, buffer.get());
+        if (AVA_FL_FAILED(result)) {
+            return result;
+        }
+
+        out_buffer->m_Data  = buffer->data();
+        out_buffer->m_Size  = buffer->size();
+        out_buffer->m_Owner = std::move(buffer);
+        return E_OK;
+    }
+
+    const StreamArchive::ArchiveEntryView* entry = container->Find(name_hash);
+    if (!entry) {
+        // throw std::runtime_error("entry was not found in the container!");
+        return E_SARC_UNKNOWN_ENTRY;
+    }
+
+    const uint8_t* data   = nullptr;
+    uint32_t       size   = 0;
+    const Result   result = StreamArchive::ReadEntry(container->m_Data, container->m_Size, *entry, &data, &size);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    out_buffer->m_Owner = container->m_Owner;
+    out_buffer->m_Data  = data;
+    out_buffer->m_Size  = size;
+    return E_OK;
+}
+
+Result PathResolver::GetContainer(const Container* parent, const std::string_view path, const std::string_view name,
+                                  ContainerPtr* out_container)
+{
+    const std::string key(path);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const auto                  it = m_Cache.find(key);
+        if (it != m_Cache.end()) {
+            m_Lru.splice(m_Lru.begin(), m_Lru, it->second);
+            *out_container = it->second->second;
+            ++m_CacheHits;
+            return E_OK;
+        }
+    }
+
+    // read and inflate the container without holding the lock, so other paths can still be resolved meanwhile
+    ResolvedBuffer buffer;
+    Result         result = ReadLayer(parent, name, &buffer);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    if (buffer.m_Size >= sizeof(uint32_t) && *(uint32_t*)buffer.m_Data == AvalancheArchiveFormat::AAF_MAGIC) {
+        auto inflated = std::make_shared<std::vector<uint8_t>>();
+        result        = AvalancheArchiveFormat::Decompress(buffer.m_Data, buffer.m_Size, inflated.get());
+        if (AVA_FL_FAILED(result)) {
+            return result;
+        }
+
+        buffer.m_Data  = inflated->data();
+        buffer.m_Size  = inflated->size();
+        buffer.m_Owner = std::move(inflated);
+    } else if (parent) {
+        // uncompressed entries point into the parent's buffer, copy them so the parent can be evicted on its own
+        auto copy      = std::make_shared<std::vector<uint8_t>>(buffer.m_Data, buffer.m_Data + buffer.m_Size);
+        buffer.m_Data  = copy->data();
+        buffer.m_Size  = copy->size();
+        buffer.m_Owner = std::move(copy);
+    }
+
+    // entries of the root layer are always read into a new buffer, so every container owns its buffer
+    auto container     = std::make_shared<Container>();
+    container->m_Owner = std::move(buffer.m_Owner);
+    container->m_Data  = buffer.m_Data;
+    container->m_Size  = buffer.m_Size;
+    container->m_Cost  = buffer.m_Size;
+
+    result = StreamArchive::Parse(container->m_Data, container->m_Size, &container->m_Entries);
+    if (AVA_FL_FAILED(result)) {
+        return result;
+    }
+
+    container->m_Index.reserve(container->m_Entries.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(container->m_Entries.size()); ++i) {
+        container->m_Index.insert(container->m_Entries[i].m_NameHash, i);
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ++m_CacheMisses;
+
+    // another thread may have resolved the same container meanwhile, keep the one which is already cached
+    const auto it = m_Cache.find(key);
+    if (it != m_Cache.end()) {
+        m_Lru.splice(m_Lru.begin(), m_Lru, it->second);
+        *out_container = it->second->second;
+        return E_OK;
+    }
+
+    m_Lru.emplace_front(key, container);
+    m_Cache.emplace(key, m_Lru.begin());
+    m_CacheSize += container->m_Cost;
+    Evict();
+
+    *out_container = std::move(container);
+    return E_OK;
+}
+
+void PathResolver::Evict()
+{
+    // the most recently used container is always kept, even if it's larger than the whole budget
+    while (m_CacheSize > m_MemoryBudget && m_Lru.size() > 1) {
+        const auto& [key, container] = m_Lru.back();
+        m_CacheSize -= container->m_Cost;
+        m_Cache.erase(key);
+        m_Lru.pop_back();
+    }
+}
+
+void PathResolver::ClearCache()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Lru.clear();
+    m_Cache.clear();
+    m_CacheSize = 0;
+}
+
+void PathResolver::SetMemoryBudget(const size_t memory_budget)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MemoryBudget = memory_budget;
+    Evict();
+}
+
+size_t PathResolver::GetMemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MemoryBudget;
+}
+
+size_t PathResolver::GetCacheSize() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_CacheSize;
+}
+
+size_t PathResolver::GetNumCachedContainers() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Cache.size();
+}
+
+uint32_t PathResolver::GetCacheHits() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_CacheHits;
+}
+
+uint32_t PathResolver::GetCacheMisses() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_CacheMisses;
+}
+}; // namespace ava::VirtualFileSystem
@@ -10,12 +10,18 @@ namespace ava::AvalancheDataFormat
 {
 Result ParseHeader(const std::vector<uint8_t>& buffer, AdfHeader* out_header, const char** out_description)
 {
-    if (buffer.empty() || buffer.size() < 24) {
+    return ParseHeader(buffer.data(), buffer.size(), out_header, out_description);
+}
+
+Result ParseHeader(const uint8_t* buffer, const size_t buffer_size, AdfHeader* out_header,
+                   const char** out_description)
+{
+    if (!buffer || buffer_size < 24) {
         // throw std::invalid_argument("ADF input buffer isn't big enough!");
         return E_INVALID_ARGUMENT;
     }
 
-    const AdfHeader* header = (AdfHeader*)buffer.data();
+    const AdfHeader* header = (AdfHeader*)buffer;
 
     if (header->m_Magic != ADF_MAGIC) {
         // throw std::runtime_error("Invalid ADF header magic!");
@@ -39,10 +45,15 @@ ADF::ADF()
 }
 
 ADF::ADF(const std::vector<uint8_t>& buffer)
-    : m_Buffer(buffer)
+    : ADF(buffer.data(), buffer.size())
+{
+}
+
+ADF::ADF(const uint8_t* buffer, const size_t buffer_size)
+    : m_Buffer(buffer, buffer + buffer_size)
     , m_Header((AdfHeader*)m_Buffer.data())
 {
-    if (buffer.empty()) {
+    if (buffer_size == 0) {
         // throw std::invalid_argument("ADF input buffer can't be empty!");
     }
 
@@ -54,7 +65,7 @@ ADF::ADF(const std::vector<uint8_t>& buffer)
     AddBuiltInTypes();
 
     // add internal types from this buffer
-    AddTypes(buffer);
+    AddTypes(m_Buffer);
 }
 
 ADF::~ADF()
@@ -64,6 +75,13 @@ ADF::~ADF()
     }
 }
 
+void ADF::AddType(AdfType* type)
+{
+    // the first type with a hash wins, same as the types vector order
+    m_TypeIndex.insert(type->m_TypeHash, static_cast<uint32_t>(m_Types.size()));
+    m_Types.push_back(type);
+}
+
 void ADF::AddBuiltInType(EAdfType type, EAdfScalarType scalar_type, uint32_t size, const char* name, uint16_t flags)
 {
     char type_name[64];
@@ -94,7 +112,7 @@ void ADF::AddBuiltInType(EAdfType type, EAdfScalarType scalar_type, uint32_t siz
     def->m_SubTypeHash = 0;
     def->m_ArraySize   = 0;
     def->m_MemberCount = 0;
-    m_Types.push_back(def);
+    AddType(def);
 }
 
 void ADF::LoadInlineOffsets(const AdfType* type, char* payload, const uint32_t offset)
@@ -170,9 +188,14 @@ void ADF::LoadInlineOffsets(const AdfType* type, char* payload, const uint32_t o
 }
 
 void ADF::AddTypes(const std::vector<uint8_t>& buffer)
+{
+    AddTypes(buffer.data(), buffer.size());
+}
+
+void ADF::AddTypes(const uint8_t* buffer, const size_t buffer_size)
 {
     AdfHeader header;
-    ParseHeader(buffer, &header);
+    ParseHeader(buffer, buffer_size, &header);
 
     // read string hashes
     {
@@ -241,7 +264,7 @@ void ADF::AddTypes(const std::vector<uint8_t>& buffer)
             }
         }
 
-        m_Types.push_back(type);
+        AddType(type);
         m_InternalTypes.push_back(type);
         types_data += size;
     }
@@ -249,9 +272,8 @@ void ADF::AddTypes(const std::vector<uint8_t>& buffer)
 
 AdfType* ADF::FindType(const uint32_t type_hash)
 {
-    const auto it = std::find_if(m_Types.begin(), m_Types.end(),
-                                 [type_hash](const AdfType* type) { return type->m_TypeHash == type_hash; });
-    return (it != m_Types.end() ? *it : nullptr);
+    const uint32_t index = m_TypeIndex.find(type_hash);
+    return (index != utils::HashIndex::INVALID_VALUE ? m_Types[index] : nullptr);
 }
 
 bool ADF::GetInstance(uint32_t index, SInstanceInfo* out_instance_info)
@@ -270,7 +292,7 @@ bool ADF::GetInstance(uint32_t index, SInstanceInfo* out_instance_info)
 
     out_instance_info->m_NameHash     = instance->m_NameHash;
     out_instance_info->m_TypeHash     = instance->m_TypeHash;
-    out_instance_info->m_Name         = GetString(instance->m_Name, m_Header, m_Buffer);
+    out_instance_info->m_Name         = GetString(instance->m_Name, m_Header, m_Buffer.data());
     out_instance_info->m_Instance     = nullptr;
     out_instance_info->m_InstanceSize = 0;
 
@@ -9,12 +9,19 @@ namespace ava::AvalancheTexture
 Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry, std::vector<uint8_t>* out_buffer,
                      const std::vector<uint8_t>& source_buffer)
 {
-    if (buffer.empty() || !out_entry || !out_buffer) {
+    return ReadBestEntry(buffer.data(), buffer.size(), out_entry, out_buffer, source_buffer.data(),
+                         source_buffer.size());
+}
+
+Result ReadBestEntry(const uint8_t* buffer, const size_t buffer_size, TextureEntry* out_entry,
+                     std::vector<uint8_t>* out_buffer, const uint8_t* source_buffer, const size_t source_buffer_size)
+{
+    if (!buffer || buffer_size == 0 || !out_entry || !out_buffer) {
         // throw std::invalid_argument("AVTX input buffer can't be empty!");
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
+    byte_array_buffer buf(buffer, buffer_size);
     std::istream      stream(&buf);
 
     // read header
@@ -31,7 +38,7 @@ Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry
     }
 
     // find the best stream to use
-    const uint8_t     stream_index = FindBestStream(header, !source_buffer.empty());
+    const uint8_t     stream_index = FindBestStream(header, (source_buffer && source_buffer_size != 0));
     const uint32_t    rank         = GetRank(header, stream_index);
     const AvtxStream& avtx_stream  = header.m_Streams[stream_index];
 
@@ -46,7 +53,7 @@ Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry
     out_buffer->resize(avtx_stream.m_Size);
 
     // copy the pixel data
-    const auto start = (avtx_stream.m_Source ? source_buffer.data() : buffer.data()) + avtx_stream.m_Offset;
+    const auto start = (avtx_stream.m_Source ? source_buffer : buffer) + avtx_stream.m_Offset;
     std::memcpy(out_buffer->data(), start, avtx_stream.m_Size);
     return E_OK;
 }
@@ -54,12 +61,19 @@ Result ReadBestEntry(const std::vector<uint8_t>& buffer, TextureEntry* out_entry
 Result ReadEntry(const std::vector<uint8_t>& buffer, const uint8_t stream_index, TextureEntry* out_entry,
                  std::vector<uint8_t>* out_buffer, const std::vector<uint8_t>& source_buffer)
 {
-    if (buffer.empty() || stream_index >= AVTX_MAX_STREAMS || !out_entry || !out_buffer) {
+    return ReadEntry(buffer.data(), buffer.size(), stream_index, out_entry, out_buffer, source_buffer.data(),
+                     source_buffer.size());
+}
+
+Result ReadEntry(const uint8_t* buffer, const size_t buffer_size, const uint8_t stream_index, TextureEntry* out_entry,
+                 std::vector<uint8_t>* out_buffer, const uint8_t* source_buffer, const size_t source_buffer_size)
+{
+    if (!buffer || buffer_size == 0 || stream_index >= AVTX_MAX_STREAMS || !out_entry || !out_buffer) {
         // throw std::invalid_argument("AVTX input buffer can't be empty!");
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
+    byte_array_buffer buf(buffer, buffer_size);
     std::istream      stream(&buf);
 
     // read header
@@ -77,7 +91,7 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const uint8_t stream_index,
 
     // the requested stream was from source, and we provided no source buffer
     const AvtxStream& avtx_stream = header.m_Streams[stream_index];
-    if (avtx_stream.m_Source && source_buffer.empty()) {
+    if (avtx_stream.m_Source && (!source_buffer || source_buffer_size == 0)) {
         // throw std::runtime_error("AVTX source buffer required!");
         return E_AVTX_SOURCE_BUFFER_NEEDED;
     }
@@ -95,7 +109,7 @@ Result ReadEntry(const std::vector<uint8_t>& buffer, const uint8_t stream_index,
     out_buffer->resize(avtx_stream.m_Size);
 
     // copy the pixel data
-    const auto start = (avtx_stream.m_Source ? source_buffer.data() : buffer.data()) + avtx_stream.m_Offset;
+    const auto start = (avtx_stream.m_Source ? source_buffer : buffer) + avtx_stream.m_Offset;
     std::memcpy(out_buffer->data(), start, avtx_stream.m_Size);
     return E_OK;
 }
@@ -104,11 +118,19 @@ Result ReadAllEntries(const std::vector<uint8_t>& buffer, AvtxHeader* out_header
                       std::vector<TextureEntry>* out_entries, std::vector<std::vector<uint8_t>>* out_buffers,
                       const std::vector<uint8_t>& source_buffer)
 {
-    if (buffer.empty() || !out_entries || !out_buffers) {
+    return ReadAllEntries(buffer.data(), buffer.size(), out_header, out_entries, out_buffers, source_buffer.data(),
+                          source_buffer.size());
+}
+
+Result ReadAllEntries(const uint8_t* buffer, const size_t buffer_size, AvtxHeader* out_header,
+                      std::vector<TextureEntry>* out_entries, std::vector<std::vector<uint8_t>>* out_buffers,
+                      const uint8_t* source_buffer, const size_t source_buffer_size)
+{
+    if (!buffer || buffer_size == 0 || !out_entries || !out_buffers) {
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
+    byte_array_buffer buf(buffer, buffer_size);
     std::istream      stream(&buf);
 
     // read header
@@ -132,7 +154,7 @@ Result ReadAllEntries(const std::vector<uint8_t>& buffer, AvtxHeader* out_header
         }
 
         // source buffer was required for this stream
-        if (stream.m_Source && source_buffer.empty()) {
+        if (stream.m_Source && (!source_buffer || source_buffer_size == 0)) {
             // return E_AVTX_SOURCE_BUFFER_NEEDED;
             continue;
         }
@@ -151,7 +173,7 @@ Result ReadAllEntries(const std::vector<uint8_t>& buffer, AvtxHeader* out_header
         out_buffer.resize(stream.m_Size);
 
         // copy the pixel data
-        const auto start = (stream.m_Source ? source_buffer.data() : buffer.data()) + stream.m_Offset;
+        const auto start = (stream.m_Source ? source_buffer : buffer) + stream.m_Offset;
         std::memcpy(out_buffer.data(), start, stream.m_Size);
 
         out_buffers->push_back(std::move(out_buffer));
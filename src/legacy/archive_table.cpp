@@ -15,6 +15,11 @@ Result Parse(const std::vector<uint8_t>& buffer, std::vector<TabEntry>* out_entr
         return E_INVALID_ARGUMENT;
     }
 
+    if (buffer.size() < sizeof(TabHeader)) {
+        // throw std::runtime_error("Invalid header magic! (Input file isn't .TAB?)");
+        return E_TAB_INVALID_MAGIC;
+    }
+
     byte_array_buffer buf(buffer);
     std::istream      stream(&buf);
 
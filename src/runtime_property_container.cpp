@@ -145,11 +145,16 @@ Container read_container(std::istream& stream)
 
 Result Parse(const std::vector<uint8_t>& buffer, Container* out_root_container)
 {
-    if (buffer.empty() || !out_root_container) {
+    return Parse(buffer.data(), buffer.size(), out_root_container);
+}
+
+Result Parse(const uint8_t* buffer, const size_t buffer_size, Container* out_root_container)
+{
+    if (!buffer || buffer_size == 0 || !out_root_container) {
         return E_INVALID_ARGUMENT;
     }
 
-    byte_array_buffer buf(buffer);
+    byte_array_buffer buf(buffer, buffer_size);
     std::istream      stream(&buf);
 
     // read header
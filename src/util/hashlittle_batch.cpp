@@ -0,0 +1,319 @@
+#include <util/hashlittle.h>
+#include <util/hashlittle_batch.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HASH_BATCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_BATCH_SSE2 1
+#endif
+
+namespace ava
+{
+#if defined(HASH_BATCH_AVX2) || defined(HASH_BATCH_SSE2)
+// transpose the 12 byte blocks of 4 keys (one per register, the 4th word is ignored) so every register holds the same
+// word of all 4 blocks
+static inline void TransposeBlocks4(const __m128i r0, const __m128i r1, const __m128i r2, const __m128i r3,
+                                    __m128i* out_w0, __m128i* out_w1, __m128i* out_w2)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    *out_w0 = _mm_unpacklo_epi64(t0, t1);
+    *out_w1 = _mm_unpackhi_epi64(t0, t1);
+    *out_w2 = _mm_unpacklo_epi64(t2, t3);
+}
+
+// block which is followed by at least 4 more bytes of the key, so it can be read with a single 16 byte load
+static inline __m128i LoadBlockWide(const char* block)
+{
+    return _mm_loadu_si128((const __m128i*)block);
+}
+
+// block which may end close to the end of the key, exactly 12 bytes are read
+static inline __m128i LoadBlockExact(const char* block)
+{
+    uint32_t last;
+    std::memcpy(&last, block + 8, sizeof(uint32_t));
+    return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)block), _mm_cvtsi32_si128((int)last));
+}
+
+template <bool WIDE>
+static inline void LoadBlocks4(const char* const* rows, const size_t offset, __m128i* out_w0, __m128i* out_w1,
+                               __m128i* out_w2)
+{
+    if constexpr (WIDE) {
+        TransposeBlocks4(LoadBlockWide(rows[0] + offset), LoadBlockWide(rows[1] + offset),
+                         LoadBlockWide(rows[2] + offset), LoadBlockWide(rows[3] + offset), out_w0, out_w1, out_w2);
+    } else {
+        TransposeBlocks4(LoadBlockExact(rows[0] + offset), LoadBlockExact(rows[1] + offset),
+                         LoadBlockExact(rows[2] + offset), LoadBlockExact(rows[3] + offset), out_w0, out_w1, out_w2);
+    }
+}
+#endif
+
+#if defined(HASH_BATCH_AVX2)
+struct HashLanes {
+    static constexpr size_t WIDTH = 8;
+    using Vec                     = __m256i;
+
+    static Vec  load(const uint32_t* values) { return _mm256_loadu_si256((const __m256i*)values); }
+    static void store(uint32_t* values, const Vec v) { _mm256_storeu_si256((__m256i*)values, v); }
+    static Vec  set1(const uint32_t value) { return _mm256_set1_epi32((int)value); }
+    static Vec  add(const Vec a, const Vec b) { return _mm256_add_epi32(a, b); }
+    static Vec  sub(const Vec a, const Vec b) { return _mm256_sub_epi32(a, b); }
+    static Vec  xor_(const Vec a, const Vec b) { return _mm256_xor_si256(a, b); }
+    template <int K> static Vec rot(const Vec x)
+    {
+        return _mm256_or_si256(_mm256_slli_epi32(x, K), _mm256_srli_epi32(x, 32 - K));
+    }
+
+    template <bool WIDE>
+    static void load_blocks(const char* const* rows, const size_t offset, Vec* out_w0, Vec* out_w1, Vec* out_w2)
+    {
+        __m128i lo[3], hi[3];
+        LoadBlocks4<WIDE>(rows, offset, &lo[0], &lo[1], &lo[2]);
+        LoadBlocks4<WIDE>(rows + 4, offset, &hi[0], &hi[1], &hi[2]);
+
+        *out_w0 = _mm256_inserti128_si256(_mm256_castsi128_si256(lo[0]), hi[0], 1);
+        *out_w1 = _mm256_inserti128_si256(_mm256_castsi128_si256(lo[1]), hi[1], 1);
+        *out_w2 = _mm256_inserti128_si256(_mm256_castsi128_si256(lo[2]), hi[2], 1);
+    }
+};
+#elif defined(HASH_BATCH_SSE2)
+struct HashLanes {
+    static constexpr size_t WIDTH = 4;
+    using Vec                     = __m128i;
+
+    static Vec  load(const uint32_t* values) { return _mm_loadu_si128((const __m128i*)values); }
+    static void store(uint32_t* values, const Vec v) { _mm_storeu_si128((__m128i*)values, v); }
+    static Vec  set1(const uint32_t value) { return _mm_set1_epi32((int)value); }
+    static Vec  add(const Vec a, const Vec b) { return _mm_add_epi32(a, b); }
+    static Vec  sub(const Vec a, const Vec b) { return _mm_sub_epi32(a, b); }
+    static Vec  xor_(const Vec a, const Vec b) { return _mm_xor_si128(a, b); }
+    template <int K> static Vec rot(const Vec x)
+    {
+        return _mm_or_si128(_mm_slli_epi32(x, K), _mm_srli_epi32(x, 32 - K));
+    }
+
+    template <bool WIDE>
+    static void load_blocks(const char* const* rows, const size_t offset, Vec* out_w0, Vec* out_w1, Vec* out_w2)
+    {
+        LoadBlocks4<WIDE>(rows, offset, out_w0, out_w1, out_w2);
+    }
+};
+#endif
+
+#if defined(HASH_BATCH_AVX2) || defined(HASH_BATCH_SSE2)
+using Vec = HashLanes::Vec;
+
+// same as hash_mix, on every lane
+static inline void MixLanes(Vec& a, Vec& b, Vec& c)
+{
+    using L = HashLanes;
+
+    a = L::xor_(L::sub(a, c), L::rot<4>(c));
+    c = L::add(c, b);
+    b = L::xor_(L::sub(b, a), L::rot<6>(a));
+    a = L::add(a, c);
+    c = L::xor_(L::sub(c, b), L::rot<8>(b));
+    b = L::add(b, a);
+    a = L::xor_(L::sub(a, c), L::rot<16>(c));
+    c = L::add(c, b);
+    b = L::xor_(L::sub(b, a), L::rot<19>(a));
+    a = L::add(a, c);
+    c = L::xor_(L::sub(c, b), L::rot<4>(b));
+    b = L::add(b, a);
+}
+
+// same as hash_final, on every lane
+static inline void FinalLanes(Vec& a, Vec& b, Vec& c)
+{
+    using L = HashLanes;
+
+    c = L::sub(L::xor_(c, b), L::rot<14>(b));
+    a = L::sub(L::xor_(a, c), L::rot<11>(c));
+    b = L::sub(L::xor_(b, a), L::rot<25>(a));
+    c = L::sub(L::xor_(c, b), L::rot<16>(b));
+    a = L::sub(L::xor_(a, c), L::rot<4>(c));
+    b = L::sub(L::xor_(b, a), L::rot<14>(a));
+    c = L::sub(L::xor_(c, b), L::rot<24>(b));
+}
+
+// last 1 to 12 bytes of a key which is at least 12 bytes long, zero padded. The 12 bytes which end at the end of the
+// key are read and shifted down, so there are no per-length branches or byte copies
+static inline void LoadLastBlock(const char* key, const size_t key_length, const size_t offset, uint32_t* out_words)
+{
+    const char* window = (key + key_length - 12);
+
+    uint64_t lo;
+    uint32_t hi32;
+    std::memcpy(&lo, window, sizeof(uint64_t));
+    std::memcpy(&hi32, window + 8, sizeof(uint32_t));
+
+    const uint64_t hi    = hi32;
+    const uint32_t shift = static_cast<uint32_t>((12 - (key_length - offset)) * 8);
+    const uint32_t s     = (shift & 63);
+
+    // (hi << 1) << (63 - s) is hi << (64 - s) without the undefined shift by 64
+    const uint64_t words_lo = (shift >= 64) ? (hi >> s) : ((lo >> s) | ((hi << 1) << (63 - s)));
+    const uint64_t words_hi = (shift >= 64) ? 0 : (hi >> s);
+
+    out_words[0] = static_cast<uint32_t>(words_lo);
+    out_words[1] = static_cast<uint32_t>(words_lo >> 32);
+    out_words[2] = static_cast<uint32_t>(words_hi);
+}
+
+// lookup3 state of every lane of a register set
+struct LaneState {
+    Vec a, b, c;
+
+    void init(const uint32_t* lengths)
+    {
+        a = HashLanes::add(HashLanes::set1(0xdeadbeef), HashLanes::load(lengths));
+        b = a;
+        c = a;
+    }
+
+    template <bool WIDE> void mix(const char* const* rows, const size_t offset)
+    {
+        Vec w0, w1, w2;
+        HashLanes::load_blocks<WIDE>(rows, offset, &w0, &w1, &w2);
+        a = HashLanes::add(a, w0);
+        b = HashLanes::add(b, w1);
+        c = HashLanes::add(c, w2);
+        MixLanes(a, b, c);
+    }
+
+    void final(const char* const* rows, uint32_t* out_hashes)
+    {
+        Vec w0, w1, w2;
+        HashLanes::load_blocks<true>(rows, 0, &w0, &w1, &w2);
+        a = HashLanes::add(a, w0);
+        b = HashLanes::add(b, w1);
+        c = HashLanes::add(c, w2);
+        FinalLanes(a, b, c);
+        HashLanes::store(out_hashes, c);
+    }
+};
+
+// the lanes of NUM_SETS register sets are hashed at once, keys with up to MAX_BUCKETS full blocks are batched
+static constexpr size_t   NUM_SETS    = 2;
+static constexpr size_t   BATCH_SIZE  = (HashLanes::WIDTH * NUM_SETS);
+static constexpr uint32_t MAX_BUCKETS = 64;
+
+// lookup3 mixes every block except the last one (1 to 12 bytes) before the final mix
+static inline uint32_t NumFullBlocks(const size_t length)
+{
+    return (length > 12) ? static_cast<uint32_t>((length - 1) / 12) : 0;
+}
+
+/**
+ * Hash BATCH_SIZE keys which all have the same number of full blocks, so every lane mixes the same number of blocks and
+ * no lane ever idles or needs masking. Two independent register sets are mixed at once, as a single set is bound by
+ * the latency of the mix.
+ */
+static void HashBatch(const std::string_view* keys, const uint32_t* indices, const uint32_t num_blocks,
+                      uint32_t* out_hashes)
+{
+    static constexpr size_t WIDTH = HashLanes::WIDTH;
+
+    const char* data[BATCH_SIZE];
+    uint32_t    lengths[BATCH_SIZE];
+    for (size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+        const std::string_view& key = keys[indices[lane]];
+        data[lane]                  = key.data();
+        lengths[lane]               = static_cast<uint32_t>(key.size());
+    }
+
+    // the sets are unrolled by hand, so their states stay in registers
+    LaneState s0, s1;
+    s0.init(lengths);
+    s1.init(lengths + WIDTH);
+
+    // every block but the last full one has at least 13 more bytes after it
+    for (uint32_t block = 0; (block + 1) < num_blocks; ++block) {
+        s0.mix<true>(data, (block * 12));
+        s1.mix<true>(data + WIDTH, (block * 12));
+    }
+
+    const size_t last_full_block = ((num_blocks - 1) * 12);
+    s0.mix<false>(data, last_full_block);
+    s1.mix<false>(data + WIDTH, last_full_block);
+
+    uint32_t    last_blocks[BATCH_SIZE][4] = {};
+    const char* rows[BATCH_SIZE];
+    for (size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+        LoadLastBlock(data[lane], lengths[lane], (num_blocks * 12), last_blocks[lane]);
+        rows[lane] = (const char*)last_blocks[lane];
+    }
+
+    uint32_t hashes[BATCH_SIZE];
+    s0.final(rows, hashes);
+    s1.final(rows + WIDTH, hashes + WIDTH);
+
+    for (size_t lane = 0; lane < BATCH_SIZE; ++lane) {
+        out_hashes[indices[lane]] = hashes[lane];
+    }
+}
+#endif
+
+size_t hashlittle_batch_width()
+{
+#if defined(HASH_BATCH_AVX2) || defined(HASH_BATCH_SSE2)
+    return BATCH_SIZE;
+#else
+    return 1;
+#endif
+}
+
+void hashlittle_batch(const std::string_view* keys, const size_t count, uint32_t* out_hashes)
+{
+#if defined(HASH_BATCH_AVX2) || defined(HASH_BATCH_SSE2)
+    // keys are staged per number of full blocks, and a batch is hashed as soon as its bucket is full, so keys are
+    // still read in (roughly) their original order. Short and very long keys are hashed one by one
+    uint32_t pending[MAX_BUCKETS][BATCH_SIZE];
+    uint32_t num_pending[MAX_BUCKETS] = {};
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t bucket = NumFullBlocks(keys[i].size());
+        if (bucket == 0 || bucket >= MAX_BUCKETS) {
+            out_hashes[i] = hashlittle(keys[i].data(), keys[i].size());
+            continue;
+        }
+
+        pending[bucket][num_pending[bucket]++] = static_cast<uint32_t>(i);
+        if (num_pending[bucket] == BATCH_SIZE) {
+            HashBatch(keys, pending[bucket], bucket, out_hashes);
+            num_pending[bucket] = 0;
+        }
+    }
+
+    // keys which don't fill a whole batch
+    for (uint32_t bucket = 0; bucket < MAX_BUCKETS; ++bucket) {
+        for (uint32_t i = 0; i < num_pending[bucket]; ++i) {
+            const uint32_t index = pending[bucket][i];
+            out_hashes[index]    = hashlittle(keys[index].data(), keys[index].size());
+        }
+    }
+#else
+    for (size_t i = 0; i < count; ++i) {
+        out_hashes[i] = hashlittle(keys[i].data(), keys[i].size());
+    }
+#endif
+}
+
+void hashlittle_batch(const std::vector<std::string>& keys, std::vector<uint32_t>* out_hashes)
+{
+    std::vector<std::string_view> views(keys.begin(), keys.end());
+
+    out_hashes->resize(keys.size());
+    hashlittle_batch(views.data(), views.size(), out_hashes->data());
+}
+}; // namespace ava
@@ -0,0 +1,114 @@
+#include <util/memory_mapped_file.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace ava::utils
+{
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        file_    = std::exchange(other.file_, nullptr);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+        file_ = std::exchange(other.file_, -1);
+#endif
+    }
+
+    return *this;
+}
+
+bool MemoryMappedFile::open(const std::filesystem::path& filename)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_    = file;
+    mapping_ = mapping;
+    data_    = (const uint8_t*)view;
+    size_    = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int file = ::open(filename.c_str(), O_RDONLY);
+    if (file == -1) {
+        return false;
+    }
+
+    struct stat st {
+    };
+    if (fstat(file, &st) != 0 || st.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        ::close(file);
+        return false;
+    }
+
+    file_ = file;
+    data_ = (const uint8_t*)view;
+    size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+
+    mapping_ = nullptr;
+    file_    = nullptr;
+#else
+    if (data_) munmap((void*)data_, size_);
+    if (file_ != -1) ::close(file_);
+
+    file_ = -1;
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+}
+} // namespace ava::utils
@@ -0,0 +1,43 @@
+#include <util/zlib.h>
+
+#include <assert.h>
+
+namespace ava::zlib
+{
+Deflater& GetThreadDeflater(const int32_t window_bits)
+{
+    assert(window_bits == -MAX_WBITS || window_bits == MAX_WBITS);
+
+    // deflate contexts are large, so only create the ones the thread actually uses
+    if (window_bits == MAX_WBITS) {
+        thread_local Deflater deflater(Z_DEFAULT_COMPRESSION, MAX_WBITS);
+        return deflater;
+    }
+
+    thread_local Deflater raw_deflater(Z_DEFAULT_COMPRESSION, -MAX_WBITS);
+    return raw_deflater;
+}
+
+Inflater& GetThreadInflater(const int32_t window_bits)
+{
+    assert(window_bits == -MAX_WBITS || window_bits == MAX_WBITS);
+
+    if (window_bits == MAX_WBITS) {
+        thread_local Inflater inflater(MAX_WBITS);
+        return inflater;
+    }
+
+    thread_local Inflater raw_inflater(-MAX_WBITS);
+    return raw_inflater;
+}
+
+int32_t Compress(const uint8_t* src, uint32_t src_len, uint8_t* dest, uint32_t* dest_len)
+{
+    return GetThreadDeflater().Compress(src, src_len, dest, dest_len);
+}
+
+int32_t Decompress(const uint8_t* src, uint32_t* src_len, uint8_t* dest, uint32_t* dest_len)
+{
+    return GetThreadInflater().Decompress(src, src_len, dest, dest_len);
+}
+}; // namespace ava::zlib
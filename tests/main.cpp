@@ -1,18 +1,34 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 
 #include <AvaFormatLib.h>
 #include <error.h>
 #include <legacy/archive_table.h>
+#include <util/byte_vector_stream.h>
+#include <util/thread_pool.h>
+#include <util/zlib.h>
 
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 
 using FileBuffer = std::vector<uint8_t>;
-bool ReadTestFile(const std::filesystem::path& filename, FileBuffer* buffer)
+std::filesystem::path GetTestFilePath(const std::filesystem::path& filename)
 {
     std::filesystem::path name = (IsDebuggerPresent() ? "../" : "");
-    name                       = name / "tests" / "data" / filename;
+    return name / "tests" / "data" / filename;
+}
+
+bool ReadTestFile(const std::filesystem::path& filename, FileBuffer* buffer)
+{
+    const auto name = GetTestFilePath(filename);
 
     try {
         const auto size = std::filesystem::file_size(name);
@@ -84,6 +100,20 @@ TEST_CASE("Archive Table Format", "[AvaFormatLib][TAB]")
         REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
     }
 
+    SECTION("can read uncompressed entries into a caller provided buffer")
+    {
+        TabEntry entry{};
+        REQUIRE(AVA_FL_SUCCEEDED(ReadEntry(tab_buffer, ava::hashlittle("hello.bin"), &entry)));
+
+        std::vector<uint8_t> file_buffer(GetEntryDecompressedSize(entry));
+        REQUIRE(AVA_FL_SUCCEEDED(ReadEntryBuffer(arc_buffer.data(), arc_buffer.size(), entry, file_buffer.data(),
+                                                 file_buffer.size())));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+
+        REQUIRE(ReadEntryBuffer(arc_buffer.data(), arc_buffer.size(), entry, file_buffer.data(), 1)
+                == ava::Result::E_TAB_ENTRY_OUT_OF_BOUNDS);
+    }
+
     SECTION("can write uncompressed entries")
     {
         // TODO
@@ -93,6 +123,21 @@ TEST_CASE("Archive Table Format", "[AvaFormatLib][TAB]")
         // REQUIRE(FilesAreTheSame(new_tab_buffer, tab_buffer));
     }
 
+    SECTION("can write and read zlib compressed entries")
+    {
+        FileBuffer t_buffer, a_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(WriteEntry(&t_buffer, &a_buffer, "world.bin", world_buffer, E_COMPRESS_LIBRARY_ZLIB)));
+
+        TabEntry entry{};
+        REQUIRE(AVA_FL_SUCCEEDED(ReadEntry(t_buffer, ava::hashlittle("world.bin"), &entry)));
+        REQUIRE(entry.m_Library == E_COMPRESS_LIBRARY_ZLIB);
+        REQUIRE(entry.m_Size < entry.m_UncompressedSize);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(ReadEntryBuffer(a_buffer, entry, &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, world_buffer));
+    }
+
     if (AVA_FL_SUCCEEDED(oodleLoadResult)) {
         SECTION("can read compressed entries")
         {
@@ -115,6 +160,558 @@ TEST_CASE("Archive Table Format", "[AvaFormatLib][TAB]")
     ava::Oodle::UnloadLib();
 }
 
+TEST_CASE("Archive Table Entry Index", "[AvaFormatLib][TAB]")
+{
+    using namespace ava::ArchiveTable;
+
+    FileBuffer tab_buffer;
+    ReadTestFile("test0.tab", &tab_buffer);
+
+    std::vector<TabEntry> entries;
+    REQUIRE(AVA_FL_SUCCEEDED(Parse(tab_buffer, &entries)));
+
+    EntryIndex index(entries);
+    REQUIRE(index.GetEntries().size() == entries.size());
+
+    SECTION("can find entries from their namehash")
+    {
+        TabEntry entry{}, indexed_entry{};
+        REQUIRE(AVA_FL_SUCCEEDED(ReadEntry(tab_buffer, ava::hashlittle("world.bin"), &entry)));
+        REQUIRE(AVA_FL_SUCCEEDED(index.ReadEntry(ava::hashlittle("world.bin"), &indexed_entry)));
+        REQUIRE(std::memcmp(&entry, &indexed_entry, sizeof(TabEntry)) == 0);
+    }
+
+    SECTION("handles unknown entries")
+    {
+        TabEntry entry{};
+        REQUIRE(index.Find(ava::hashlittle("missing.bin")) == nullptr);
+        REQUIRE(index.ReadEntry(ava::hashlittle("missing.bin"), &entry) == ava::Result::E_TAB_UNKNOWN_ENTRY);
+    }
+}
+
+TEST_CASE("Archive Table Entry Index Benchmark", "[AvaFormatLib][TAB][!benchmark]")
+{
+    using namespace ava::ArchiveTable;
+
+    // synthetic TAB with 100k entries
+    static constexpr uint32_t num_entries = 100000;
+
+    FileBuffer                   tab_buffer;
+    ava::utils::ByteVectorStream buf(&tab_buffer);
+    buf.write(TabHeader{});
+    buf.write((uint32_t)0);
+
+    std::vector<uint32_t> name_hashes;
+    for (uint32_t i = 0; i < num_entries; ++i) {
+        const std::string filename = "entry_" + std::to_string(i) + ".bin";
+
+        TabEntry entry{};
+        entry.m_NameHash = ava::hashlittle(filename.c_str());
+        entry.m_Offset   = i;
+        entry.m_Size     = 1;
+        buf.write(entry);
+
+        if ((i % 997) == 0) {
+            name_hashes.push_back(entry.m_NameHash);
+        }
+    }
+
+    std::vector<TabEntry> entries;
+    REQUIRE(AVA_FL_SUCCEEDED(Parse(tab_buffer, &entries)));
+
+    size_t current = 0;
+    BENCHMARK("ReadEntry (parse + linear search)")
+    {
+        TabEntry entry{};
+        return ReadEntry(tab_buffer, name_hashes[current++ % name_hashes.size()], &entry);
+    };
+
+    BENCHMARK("EntryIndex build")
+    {
+        return EntryIndex(entries);
+    };
+
+    EntryIndex index(entries);
+    BENCHMARK("EntryIndex::Find")
+    {
+        return index.Find(name_hashes[current++ % name_hashes.size()]);
+    };
+}
+
+TEST_CASE("Archive Table Handle", "[AvaFormatLib][TAB]")
+{
+    using namespace ava::ArchiveTable;
+
+    FileBuffer hello_buffer;
+    ReadTestFile("hello.bin", &hello_buffer);
+
+    SECTION("handles missing files")
+    {
+        ArchiveHandle archive;
+        REQUIRE(archive.Open(GetTestFilePath("missing.tab"), GetTestFilePath("missing.arc"))
+                == ava::Result::E_FAILED_TO_OPEN_FILE);
+        REQUIRE_FALSE(archive.IsOpen());
+    }
+
+    SECTION("can read uncompressed entries from the mapped archive")
+    {
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(GetTestFilePath("test0.tab"), GetTestFilePath("test0.arc"))));
+        REQUIRE(archive.IsOpen());
+        REQUIRE(archive.GetEntries().size() == 2);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("hello.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+
+        REQUIRE(archive.ReadEntryBuffer(ava::hashlittle("missing.bin"), &file_buffer)
+                == ava::Result::E_TAB_UNKNOWN_ENTRY);
+    }
+
+    SECTION("can batch read entries")
+    {
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(GetTestFilePath("test0.tab"), GetTestFilePath("test0.arc"))));
+
+        const std::vector<uint32_t> name_hashes{ava::hashlittle("missing.bin"), ava::hashlittle("hello.bin")};
+
+        std::mutex                      mutex;
+        std::map<uint32_t, ava::Result> results;
+        std::map<uint32_t, FileBuffer>  buffers;
+        BatchStats                      stats{};
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffers(
+            name_hashes,
+            [&](const TabEntry& entry, ava::Result result, std::vector<uint8_t>&& buffer) {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[entry.m_NameHash] = result;
+                buffers[entry.m_NameHash] = std::move(buffer);
+            },
+            2, &stats)));
+
+        REQUIRE(results.size() == 2);
+        REQUIRE(results[ava::hashlittle("missing.bin")] == ava::Result::E_TAB_UNKNOWN_ENTRY);
+        REQUIRE(results[ava::hashlittle("hello.bin")] == ava::Result::E_OK);
+        REQUIRE(FilesAreTheSame(buffers[ava::hashlittle("hello.bin")], hello_buffer));
+
+        REQUIRE(stats.m_NumWorkers == 2);
+        REQUIRE(stats.m_NumEntries == 1);
+        REQUIRE(stats.m_NumFailed == 1);
+        REQUIRE(stats.m_BytesWritten == hello_buffer.size());
+    }
+}
+
+TEST_CASE("Archive Table Builder", "[AvaFormatLib][TAB]")
+{
+    using namespace ava::ArchiveTable;
+
+    FileBuffer hello_buffer, world_buffer;
+    ReadTestFile("hello.bin", &hello_buffer);
+    ReadTestFile("world.bin", &world_buffer);
+
+    const auto tab_filename = std::filesystem::temp_directory_path() / "ava_format_lib_builder.tab";
+    const auto arc_filename = std::filesystem::temp_directory_path() / "ava_format_lib_builder.arc";
+
+    SECTION("handles invalid input arguments")
+    {
+        ArchiveBuilder builder;
+        REQUIRE(builder.AddEntry("hello.bin", hello_buffer) == ava::Result::E_INVALID_ARGUMENT);
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Open(arc_filename)));
+        REQUIRE(builder.AddEntry("hello.bin", {}) == ava::Result::E_INVALID_ARGUMENT);
+        REQUIRE(builder.Finish((std::vector<uint8_t>*)nullptr) == ava::Result::E_INVALID_ARGUMENT);
+    }
+
+    SECTION("can write aligned uncompressed entries")
+    {
+        TabHeader header;
+        header.m_Alignment = 0x10;
+
+        ArchiveBuilder builder(header);
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Open(arc_filename)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("hello.bin", hello_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("world.bin", world_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Finish(tab_filename)));
+
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(tab_filename, arc_filename)));
+        REQUIRE(archive.GetEntries().size() == 2);
+        REQUIRE(archive.GetEntries()[0].m_Offset == 0);
+        REQUIRE(archive.GetEntries()[1].m_Offset == ava::math::align((uint32_t)hello_buffer.size(), 0x10));
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("hello.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("world.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, world_buffer));
+    }
+
+    SECTION("can write zlib compressed entries split into blocks")
+    {
+        TabHeader header;
+        header.m_UncompressedBlockSize = 0x100;
+
+        ArchiveBuilder builder(header);
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Open(arc_filename)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("hello.bin", hello_buffer, E_COMPRESS_LIBRARY_ZLIB)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("world.bin", world_buffer, E_COMPRESS_LIBRARY_ZLIB)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Finish(tab_filename)));
+
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(tab_filename, arc_filename)));
+        REQUIRE(archive.GetHeader().m_UncompressedBlockSize == 0x100);
+        REQUIRE(archive.GetCompressionBlocks().size() == (1 + ((world_buffer.size() + 0xFF) / 0x100)));
+
+        TabEntry entry{};
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntry(ava::hashlittle("world.bin"), &entry)));
+        REQUIRE(entry.m_CompressedBlockIndex == 1);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(entry, &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, world_buffer));
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("hello.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+    }
+
+    std::filesystem::remove(tab_filename);
+    std::filesystem::remove(arc_filename);
+}
+
+TEST_CASE("Archive Table Patcher", "[AvaFormatLib][TAB]")
+{
+    using namespace ava::ArchiveTable;
+
+    FileBuffer hello_buffer, world_buffer;
+    ReadTestFile("hello.bin", &hello_buffer);
+    ReadTestFile("world.bin", &world_buffer);
+
+    // patch a copy of the test archive
+    const auto tab_filename = std::filesystem::temp_directory_path() / "ava_format_lib_patcher.tab";
+    const auto arc_filename = std::filesystem::temp_directory_path() / "ava_format_lib_patcher.arc";
+    std::filesystem::copy_file(GetTestFilePath("test0.tab"), tab_filename,
+                               std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::copy_file(GetTestFilePath("test0.arc"), arc_filename,
+                               std::filesystem::copy_options::overwrite_existing);
+
+    const auto tab_size = std::filesystem::file_size(tab_filename);
+    const auto arc_size = std::filesystem::file_size(arc_filename);
+
+    SECTION("handles invalid input arguments")
+    {
+        ArchivePatcher patcher;
+        REQUIRE(patcher.PatchEntry("hello.bin", hello_buffer) == ava::Result::E_INVALID_ARGUMENT);
+        REQUIRE(patcher.Open(GetTestFilePath("missing.tab"), GetTestFilePath("missing.arc"))
+                == ava::Result::E_FAILED_TO_OPEN_FILE);
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.Open(tab_filename, arc_filename)));
+        REQUIRE(patcher.PatchEntry("hello.bin", {}) == ava::Result::E_INVALID_ARGUMENT);
+    }
+
+    SECTION("can patch entries in place and append entries which don't fit")
+    {
+        const FileBuffer small_buffer(hello_buffer.begin(), hello_buffer.begin() + 16);
+
+        ArchivePatcher patcher;
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.Open(tab_filename, arc_filename)));
+
+        // world.bin is the last entry, so its aligned slot can hold hello.bin
+        bool in_place = false;
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("world.bin", hello_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        REQUIRE(in_place);
+
+        // hello.bin is followed by world.bin, so it can only shrink in place
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("hello.bin", small_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        REQUIRE(in_place);
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("hello.bin", world_buffer, E_COMPRESS_LIBRARY_ZLIB, &in_place)));
+        REQUIRE_FALSE(in_place);
+
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("new.bin", small_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        REQUIRE_FALSE(in_place);
+        patcher.Close();
+
+        REQUIRE(std::filesystem::file_size(tab_filename) == (tab_size + sizeof(TabEntry)));
+        REQUIRE(std::filesystem::file_size(arc_filename) > arc_size);
+
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(tab_filename, arc_filename)));
+        REQUIRE(archive.GetEntries().size() == 3);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("hello.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, world_buffer));
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("world.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("new.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, small_buffer));
+    }
+
+    SECTION("doesn't patch entries which share their data in place")
+    {
+        const FileBuffer small_buffer(hello_buffer.begin(), hello_buffer.begin() + 16);
+
+        // deduplicate world.bin, so it points at the data of hello.bin
+        FileBuffer            tab_buffer;
+        std::vector<TabEntry> entries;
+        ReadTestFile("test0.tab", &tab_buffer);
+        REQUIRE(AVA_FL_SUCCEEDED(Parse(tab_buffer, &entries)));
+
+        const auto hello = std::find_if(entries.begin(), entries.end(), [](const TabEntry& entry) {
+            return entry.m_NameHash == ava::hashlittle("hello.bin");
+        });
+        const auto world = std::find_if(entries.begin(), entries.end(), [](const TabEntry& entry) {
+            return entry.m_NameHash == ava::hashlittle("world.bin");
+        });
+        REQUIRE(hello != entries.end());
+        REQUIRE(world != entries.end());
+
+        const auto record = std::search(tab_buffer.begin(), tab_buffer.end(), (const uint8_t*)&(*world),
+                                        (const uint8_t*)&(*world) + sizeof(TabEntry));
+        REQUIRE(record != tab_buffer.end());
+
+        TabEntry deduplicated = *hello;
+        deduplicated.m_NameHash = world->m_NameHash;
+        std::memcpy(&(*record), &deduplicated, sizeof(TabEntry));
+
+        std::ofstream(tab_filename, std::ios::binary | std::ios::trunc)
+            .write((const char*)tab_buffer.data(), tab_buffer.size());
+
+        ArchivePatcher patcher;
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.Open(tab_filename, arc_filename)));
+
+        // hello.bin would fit in place, but world.bin still uses its data
+        bool in_place = true;
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("hello.bin", small_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        REQUIRE_FALSE(in_place);
+
+        // world.bin is the only entry left in the slot now
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("world.bin", small_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        REQUIRE(in_place);
+        REQUIRE(AVA_FL_SUCCEEDED(patcher.PatchEntry("world.bin", hello_buffer, E_COMPRESS_LIBRARY_NONE, &in_place)));
+        patcher.Close();
+
+        ArchiveHandle archive;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.Open(tab_filename, arc_filename)));
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("hello.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, small_buffer));
+        REQUIRE(AVA_FL_SUCCEEDED(archive.ReadEntryBuffer(ava::hashlittle("world.bin"), &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+    }
+
+    std::filesystem::remove(tab_filename);
+    std::filesystem::remove(arc_filename);
+}
+
+TEST_CASE("Virtual File System", "[AvaFormatLib][TAB][VFS]")
+{
+    using namespace ava::VirtualFileSystem;
+
+    FileBuffer hello_buffer, world_buffer;
+    ReadTestFile("hello.bin", &hello_buffer);
+    ReadTestFile("world.bin", &world_buffer);
+
+    // patch archive which replaces hello.bin with the contents of world.bin
+    const auto tab_filename = std::filesystem::temp_directory_path() / "ava_format_lib_vfs_patch.tab";
+    const auto arc_filename = std::filesystem::temp_directory_path() / "ava_format_lib_vfs_patch.arc";
+    {
+        ava::ArchiveTable::ArchiveBuilder builder;
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Open(arc_filename)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("hello.bin", world_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Finish(tab_filename)));
+    }
+
+    SECTION("handles missing files")
+    {
+        FileSystem vfs;
+        REQUIRE(vfs.Mount(GetTestFilePath("missing.tab"), GetTestFilePath("missing.arc"))
+                == ava::Result::E_FAILED_TO_OPEN_FILE);
+        REQUIRE(vfs.MountLegacy(GetTestFilePath("missing.tab"), GetTestFilePath("missing.arc"))
+                == ava::Result::E_FAILED_TO_OPEN_FILE);
+        REQUIRE(vfs.GetNumMounts() == 0);
+    }
+
+    SECTION("can read entries from legacy and current archives")
+    {
+        FileSystem vfs;
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(GetTestFilePath("test0.tab"), GetTestFilePath("test0.arc"))));
+        REQUIRE(AVA_FL_SUCCEEDED(
+            vfs.MountLegacy(GetTestFilePath("test0_legacy.tab"), GetTestFilePath("test0_legacy.arc"))));
+        REQUIRE(vfs.GetNumMounts() == 2);
+        REQUIRE(vfs.GetNumEntries() == 2);
+
+        // equal priorities, the last mount wins
+        uint32_t mount_index = INVALID_MOUNT;
+        REQUIRE(vfs.Find(ava::hashlittle("hello.bin"), &mount_index) != nullptr);
+        REQUIRE(mount_index == 1);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.ReadEntryBuffer("hello.bin", &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+
+        REQUIRE(vfs.ReadEntryBuffer("missing.bin", &file_buffer) == ava::Result::E_TAB_UNKNOWN_ENTRY);
+    }
+
+    SECTION("higher priority mounts override entries")
+    {
+        FileSystem vfs;
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(tab_filename, arc_filename, 1)));
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(GetTestFilePath("test0.tab"), GetTestFilePath("test0.arc"))));
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.ReadEntryBuffer("hello.bin", &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, world_buffer));
+
+        vfs.Clear();
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(tab_filename, arc_filename, -1)));
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(GetTestFilePath("test0.tab"), GetTestFilePath("test0.arc"))));
+
+        REQUIRE(AVA_FL_SUCCEEDED(vfs.ReadEntryBuffer("hello.bin", &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, hello_buffer));
+    }
+
+    std::filesystem::remove(tab_filename);
+    std::filesystem::remove(arc_filename);
+}
+
+TEST_CASE("Virtual File System Path Resolver", "[AvaFormatLib][TAB][AAF][SARC][VFS]")
+{
+    using namespace ava::VirtualFileSystem;
+
+    FileBuffer ee_buffer, sarc_buffer;
+    ReadTestFile("grapplinghookwire.ee", &ee_buffer);
+    REQUIRE(AVA_FL_SUCCEEDED(ava::AvalancheArchiveFormat::Decompress(ee_buffer, &sarc_buffer)));
+
+    std::vector<ava::StreamArchive::ArchiveEntry> entries;
+    REQUIRE(AVA_FL_SUCCEEDED(ava::StreamArchive::Parse(sarc_buffer, &entries)));
+
+    // uncompressed SARC which nests the compressed .ee
+    FileBuffer outer_buffer;
+    {
+        ava::StreamArchive::ArchiveBuilder builder;
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("editor/grapplinghookwire.ee", ee_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Write(&outer_buffer)));
+    }
+
+    // uncompressed SARC which nests the uncompressed outer SARC
+    FileBuffer nested_buffer;
+    {
+        ava::StreamArchive::ArchiveBuilder builder;
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("editor/outer.sarc", outer_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Write(&nested_buffer)));
+    }
+
+    const auto tab_filename = std::filesystem::temp_directory_path() / "ava_format_lib_resolver.tab";
+    const auto arc_filename = std::filesystem::temp_directory_path() / "ava_format_lib_resolver.arc";
+    {
+        ava::ArchiveTable::ArchiveBuilder builder;
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Open(arc_filename)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("game/grapplinghookwire.ee", ee_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("game/outer.sarc", outer_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry("game/nested.sarc", nested_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(builder.Finish(tab_filename)));
+    }
+
+    FileSystem vfs;
+    REQUIRE(AVA_FL_SUCCEEDED(vfs.Mount(tab_filename, arc_filename)));
+
+    const auto& epe_entry     = entries[80];
+    const auto& sibling_entry = entries[0];
+
+    SECTION("handles invalid input arguments")
+    {
+        PathResolver   resolver(vfs);
+        ResolvedBuffer buffer;
+        REQUIRE(resolver.Resolve("", &buffer) == ava::Result::E_INVALID_ARGUMENT);
+        REQUIRE(resolver.Resolve("game/grapplinghookwire.ee", (ResolvedBuffer*)nullptr)
+                == ava::Result::E_INVALID_ARGUMENT);
+        REQUIRE(resolver.Resolve("game/missing.ee/missing.epe", &buffer) == ava::Result::E_TAB_UNKNOWN_ENTRY);
+        REQUIRE(resolver.Resolve("game/grapplinghookwire.ee/missing.epe", &buffer)
+                == ava::Result::E_SARC_UNKNOWN_ENTRY);
+    }
+
+    SECTION("can resolve nested paths")
+    {
+        PathResolver resolver(vfs);
+
+        std::vector<uint8_t> file_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/grapplinghookwire.ee", &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, ee_buffer));
+
+        std::vector<uint8_t> expected_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(ava::StreamArchive::ReadEntry(sarc_buffer, epe_entry, &expected_buffer)));
+
+        REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/grapplinghookwire.ee/" + epe_entry.m_Filename, &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, expected_buffer));
+
+        REQUIRE(AVA_FL_SUCCEEDED(
+            resolver.Resolve("game/outer.sarc/editor/grapplinghookwire.ee/" + epe_entry.m_Filename, &file_buffer)));
+        REQUIRE(FilesAreTheSame(file_buffer, expected_buffer));
+        REQUIRE(resolver.GetNumCachedContainers() == 3);
+    }
+
+    SECTION("siblings reuse the cached container")
+    {
+        PathResolver resolver(vfs);
+
+        ResolvedBuffer epe_buffer, sibling_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/grapplinghookwire.ee/" + epe_entry.m_Filename, &epe_buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(
+            resolver.Resolve("game/grapplinghookwire.ee/" + sibling_entry.m_Filename, &sibling_buffer)));
+        REQUIRE(resolver.GetCacheMisses() == 1);
+        REQUIRE(resolver.GetCacheHits() == 1);
+
+        // both buffers point into the same inflated container
+        REQUIRE(epe_buffer.m_Owner == sibling_buffer.m_Owner);
+        REQUIRE(epe_buffer.m_Size == epe_entry.m_Size);
+        REQUIRE(sibling_buffer.m_Size == sibling_entry.m_Size);
+        REQUIRE(resolver.GetCacheSize() == sarc_buffer.size());
+    }
+
+    SECTION("containers are evicted over the memory budget")
+    {
+        PathResolver resolver(vfs, sarc_buffer.size());
+
+        ResolvedBuffer buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/grapplinghookwire.ee/" + epe_entry.m_Filename, &buffer)));
+        REQUIRE(AVA_FL_SUCCEEDED(
+            resolver.Resolve("game/outer.sarc/editor/grapplinghookwire.ee/" + epe_entry.m_Filename, &buffer)));
+        REQUIRE(resolver.GetCacheSize() <= resolver.GetMemoryBudget());
+
+        // evicted buffers stay alive while they are still referenced
+        std::vector<uint8_t> expected_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(ava::StreamArchive::ReadEntry(sarc_buffer, epe_entry, &expected_buffer)));
+        resolver.ClearCache();
+        REQUIRE(resolver.GetNumCachedContainers() == 0);
+        REQUIRE(std::memcmp(buffer.m_Data, expected_buffer.data(), expected_buffer.size()) == 0);
+    }
+
+    SECTION("uncompressed nested containers count towards the memory budget")
+    {
+        PathResolver resolver(vfs);
+
+        std::weak_ptr<const std::vector<uint8_t>> nested_owner;
+        {
+            ResolvedBuffer buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/nested.sarc/editor/outer.sarc", &buffer)));
+            nested_owner = buffer.m_Owner;
+
+            REQUIRE(AVA_FL_SUCCEEDED(resolver.Resolve("game/nested.sarc/editor/outer.sarc/editor/grapplinghookwire.ee/"
+                                                          + epe_entry.m_Filename,
+                                                      &buffer)));
+        }
+
+        REQUIRE(resolver.GetNumCachedContainers() == 3);
+        REQUIRE(resolver.GetCacheSize() == (nested_buffer.size() + outer_buffer.size() + sarc_buffer.size()));
+
+        // the outer container owns a copy of its buffer, so evicting the container it came from frees that buffer
+        resolver.SetMemoryBudget(outer_buffer.size() + sarc_buffer.size());
+        REQUIRE(resolver.GetNumCachedContainers() == 2);
+        REQUIRE(resolver.GetCacheSize() == (outer_buffer.size() + sarc_buffer.size()));
+        REQUIRE(nested_owner.expired());
+    }
+
+    std::filesystem::remove(tab_filename);
+    std::filesystem::remove(arc_filename);
+}
+
 TEST_CASE("Archive Table Format (LEGACY)", "[AvaFormatLib][TAB]")
 {
     using namespace ava::legacy::ArchiveTable;
@@ -162,6 +759,260 @@ TEST_CASE("Archive Table Format (LEGACY)", "[AvaFormatLib][TAB]")
     }
 }
 
+TEST_CASE("Oodle Codec", "[AvaFormatLib][Oodle]")
+{
+    using namespace ava::Oodle;
+
+    FileBuffer hello_buffer;
+    ReadTestFile("hello.bin", &hello_buffer);
+
+    SECTION("fails when the library isn't loaded")
+    {
+        Codec codec;
+        REQUIRE_FALSE(codec.IsLoaded());
+
+        FileBuffer out_buffer(GetCompressedBufferSizeNeeded(hello_buffer.size()));
+        REQUIRE(codec.Compress(hello_buffer.data(), hello_buffer.size(), out_buffer.data()) == 0);
+        REQUIRE(codec.Decompress(hello_buffer.data(), hello_buffer.size(), out_buffer.data(), out_buffer.size()) == 0);
+    }
+
+    SECTION("fails to load invalid libraries")
+    {
+        Codec codec;
+        REQUIRE(codec.Load(GetTestFilePath("missing.dll").string().c_str()) == ava::Result::E_OODLE_LIBRARY_MISSING);
+        REQUIRE_FALSE(codec.IsLoaded());
+
+        // exists, but isn't a library
+        REQUIRE(codec.Load(GetTestFilePath("hello.bin").string().c_str()) == ava::Result::E_OODLE_FAILED_TO_LOAD);
+        REQUIRE_FALSE(codec.IsLoaded());
+    }
+
+    Codec codec;
+    if (AVA_FL_SUCCEEDED(codec.Load("D:/Steam/steamapps/common/Just Cause 4/oo2core_7_win64.dll"))) {
+        SECTION("can decompress on many threads at once")
+        {
+            FileBuffer    compressed_buffer(GetCompressedBufferSizeNeeded(hello_buffer.size()));
+            const int64_t compressed_size =
+                codec.Compress(hello_buffer.data(), hello_buffer.size(), compressed_buffer.data());
+            REQUIRE(compressed_size > 0);
+            compressed_buffer.resize(compressed_size);
+
+            std::atomic<uint32_t> num_failed = 0;
+            ava::utils::parallel_for(ava::utils::ThreadPool::shared(), 256, [&](size_t) {
+                FileBuffer out_buffer(hello_buffer.size());
+                const int64_t size = codec.Decompress(compressed_buffer.data(), compressed_buffer.size(),
+                                                      out_buffer.data(), out_buffer.size());
+                if (size != static_cast<int64_t>(hello_buffer.size()) || out_buffer != hello_buffer) {
+                    ++num_failed;
+                }
+            });
+
+            REQUIRE(num_failed == 0);
+        }
+    }
+}
+
+TEST_CASE("Thread Pool", "[AvaFormatLib][Util]")
+{
+    using namespace ava::utils;
+
+    ThreadPool pool(4);
+
+    SECTION("parallel_for visits every index once")
+    {
+        std::vector<std::atomic<uint32_t>> visits(1000);
+        parallel_for(pool, visits.size(), [&](const size_t i) { visits[i]++; });
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](const auto& count) { return count == 1; }));
+    }
+
+    SECTION("parallel_for can be nested inside pool tasks")
+    {
+        std::atomic<uint32_t> total = 0;
+        parallel_for(pool, 8, [&](size_t) { parallel_for(pool, 8, [&](size_t) { total++; }); });
+        REQUIRE(total == 64);
+    }
+
+    SECTION("parallel_for rethrows exceptions after every index is finished")
+    {
+        std::atomic<uint32_t> total = 0;
+        REQUIRE_THROWS_AS(parallel_for(pool, 100,
+                                       [&](const size_t i) {
+                                           total++;
+                                           if (i % 10 == 0) {
+                                               throw std::runtime_error("failed");
+                                           }
+                                       }),
+                          std::runtime_error);
+        REQUIRE(total == 100);
+    }
+}
+
+TEST_CASE("Zlib Contexts", "[AvaFormatLib][Util]")
+{
+    using namespace ava::zlib;
+
+    std::vector<uint8_t> buffer(64 * 1024);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = static_cast<uint8_t>((i * 7) ^ (i >> 5));
+    }
+
+    SECTION("thread contexts are reused")
+    {
+        REQUIRE(&GetThreadDeflater() == &GetThreadDeflater());
+        REQUIRE(&GetThreadInflater() == &GetThreadInflater());
+        REQUIRE(&GetThreadInflater(MAX_WBITS) != &GetThreadInflater());
+    }
+
+    SECTION("can compress and decompress many buffers")
+    {
+        std::vector<uint8_t> compressed(compressBound(static_cast<uint32_t>(buffer.size())));
+        std::vector<uint8_t> decompressed(buffer.size());
+
+        for (uint32_t size = 1; size <= buffer.size(); size *= 4) {
+            uint32_t compressed_size = static_cast<uint32_t>(compressed.size());
+            REQUIRE(Compress(buffer.data(), size, compressed.data(), &compressed_size) == Z_OK);
+
+            uint32_t src_len           = compressed_size;
+            uint32_t decompressed_size = size;
+            REQUIRE(Decompress(compressed.data(), &src_len, decompressed.data(), &decompressed_size) == Z_OK);
+            REQUIRE(decompressed_size == size);
+            REQUIRE(std::equal(buffer.begin(), buffer.begin() + size, decompressed.begin()));
+        }
+    }
+
+    SECTION("can decompress the start of a buffer")
+    {
+        std::vector<uint8_t> compressed(compressBound(static_cast<uint32_t>(buffer.size())));
+        uint32_t             compressed_size = static_cast<uint32_t>(compressed.size());
+        REQUIRE(Compress(buffer.data(), static_cast<uint32_t>(buffer.size()), compressed.data(), &compressed_size)
+                == Z_OK);
+
+        std::vector<uint8_t> prefix(100);
+        REQUIRE(GetThreadInflater().DecompressPrefix(compressed.data(), compressed_size, prefix.data(), 100) == Z_OK);
+        REQUIRE(std::equal(prefix.begin(), prefix.end(), buffer.begin()));
+
+        // can't read past the end of the buffer
+        prefix.resize(buffer.size() + 1);
+        REQUIRE(GetThreadInflater().DecompressPrefix(compressed.data(), compressed_size, prefix.data(),
+                                                     static_cast<uint32_t>(prefix.size()))
+                != Z_OK);
+    }
+}
+
+TEST_CASE("Batched Hashlittle", "[AvaFormatLib][Util]")
+{
+    // every length up to a few blocks, at every alignment
+    const std::string text = "editor/entities/gameobjects/grapplinghookwire/grapplinghookwire_01.epe";
+
+    std::vector<std::string_view> keys;
+    for (size_t offset = 0; offset < 4; ++offset) {
+        for (size_t length = 0; length <= (text.length() - offset); ++length) {
+            keys.emplace_back(text.data() + offset, length);
+        }
+    }
+
+    std::vector<uint32_t> hashes(keys.size());
+    ava::hashlittle_batch(keys.data(), keys.size(), hashes.data());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(hashes[i] == ava::hashlittle(keys[i].data(), keys[i].size()));
+    }
+
+    // enough strings of every block count to fill whole batches
+    std::mt19937             rng(1234);
+    std::vector<std::string> random_strings(20000);
+    for (std::string& string : random_strings) {
+        string.resize(rng() % 800);
+        for (char& c : string) {
+            c = static_cast<char>(rng());
+        }
+    }
+
+    std::vector<uint32_t> random_hashes, expected_hashes;
+    ava::hashlittle_batch(random_strings, &random_hashes);
+    for (const std::string& string : random_strings) {
+        expected_hashes.push_back(ava::hashlittle(string.data(), string.size()));
+    }
+
+    REQUIRE(random_hashes == expected_hashes);
+
+    std::vector<uint32_t> string_hashes;
+    ava::hashlittle_batch(std::vector<std::string>{"hello.bin", "world.bin", ""}, &string_hashes);
+    REQUIRE(string_hashes.size() == 3);
+    REQUIRE(string_hashes[0] == ava::hashlittle("hello.bin"));
+    REQUIRE(string_hashes[1] == ava::hashlittle("world.bin"));
+    REQUIRE(string_hashes[2] == ava::hashlittle(""));
+}
+
+TEST_CASE("Compile Time Hashes", "[AvaFormatLib][Util]")
+{
+    static_assert(ava::hashlittle_constexpr(".epe") == 0xDFA53895);
+    static_assert("editor/entities/gameobjects/grapplinghookwire.epe"_hash_little == 0x622C1045);
+    static_assert(ava::HashString64_constexpr("SShaderBundle") == 0x560450C4FFED4F6D);
+
+    const auto extension_kind = [](const uint32_t extension_hash) {
+        switch (extension_hash) {
+            case ".epe"_hash_little: return 1;
+            case ".ee"_hash_little: return 2;
+            default: return 0;
+        }
+    };
+
+    REQUIRE(extension_kind(ava::hashlittle(".epe")) == 1);
+    REQUIRE(extension_kind(ava::hashlittle(".ee")) == 2);
+    REQUIRE(extension_kind(ava::hashlittle(".bin")) == 0);
+
+    // every length up to a few blocks
+    const std::string text = "editor/entities/gameobjects/grapplinghookwire/grapplinghookwire_01.epe";
+    for (size_t length = 0; length <= text.length(); ++length) {
+        REQUIRE(ava::hashlittle_constexpr(text.data(), length) == ava::hashlittle(text.data(), length));
+
+        uint64_t hash[2];
+        uint64_t constexpr_hash[2];
+        ava::MurmurHash3_x64_128(text.data(), static_cast<int>(length), 0, hash);
+        ava::MurmurHash3_x64_128_constexpr(text.data(), static_cast<int>(length), 0, constexpr_hash);
+        REQUIRE(hash[0] == constexpr_hash[0]);
+        REQUIRE(hash[1] == constexpr_hash[1]);
+    }
+
+    REQUIRE(ava::HashString64_constexpr("hello.bin") == ava::HashString64("hello.bin"));
+}
+
+TEST_CASE("Batched Hashlittle Benchmark", "[AvaFormatLib][Util][!benchmark]")
+{
+    // filelist built from the entry names of a real SARC
+    FileBuffer ee_buffer, sarc_buffer;
+    ReadTestFile("grapplinghookwire.ee", &ee_buffer);
+    REQUIRE(AVA_FL_SUCCEEDED(ava::AvalancheArchiveFormat::Decompress(ee_buffer, &sarc_buffer)));
+
+    std::vector<ava::StreamArchive::ArchiveEntry> entries;
+    REQUIRE(AVA_FL_SUCCEEDED(ava::StreamArchive::Parse(sarc_buffer, &entries)));
+
+    std::vector<std::string> filenames;
+    for (uint32_t i = 0; i < 100000; ++i) {
+        const std::string& filename = entries[i % entries.size()].m_Filename;
+        filenames.push_back(std::to_string(i / entries.size()) + "/" + filename);
+    }
+
+    std::vector<std::string_view> keys(filenames.begin(), filenames.end());
+    std::vector<uint32_t>         hashes(keys.size());
+
+    BENCHMARK("hashlittle")
+    {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            hashes[i] = ava::hashlittle(keys[i].data(), keys[i].size());
+        }
+
+        return hashes.back();
+    };
+
+    BENCHMARK("hashlittle_batch")
+    {
+        ava::hashlittle_batch(keys.data(), keys.size(), hashes.data());
+        return hashes.back();
+    };
+}
+
 TEST_CASE("Avalanche Archive Format", "[AvaFormatLib][AAF]")
 {
     using namespace ava::AvalancheArchiveFormat;
@@ -176,6 +1027,58 @@ TEST_CASE("Avalanche Archive Format", "[AvaFormatLib][AAF]")
         REQUIRE(Decompress(buffer, nullptr) == ava::Result::E_INVALID_ARGUMENT);
         REQUIRE(Compress({}, &out_buffer) == ava::Result::E_INVALID_ARGUMENT);
         REQUIRE(Compress(buffer, nullptr) == ava::Result::E_INVALID_ARGUMENT);
+
+        const FileBuffer truncated_buffer(buffer.begin(), buffer.begin() + (buffer.size() / 2));
+        REQUIRE(Decompress(truncated_buffer, &out_buffer) == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+        REQUIRE(out_buffer.empty());
+
+        // chunk sizes must match the header
+        FileBuffer corrupt_buffer = buffer;
+        AafHeader  header;
+        std::memcpy(&header, corrupt_buffer.data(), sizeof(AafHeader));
+        header.m_TotalUnpackedSize += 1;
+        std::memcpy(corrupt_buffer.data(), &header, sizeof(AafHeader));
+        REQUIRE(Decompress(corrupt_buffer, &out_buffer) == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+        REQUIRE(out_buffer.empty());
+
+        header.m_TotalUnpackedSize -= 1;
+        header.m_RequiredUnpackBufferSize -= 1;
+        std::memcpy(corrupt_buffer.data(), &header, sizeof(AafHeader));
+        REQUIRE(Decompress(corrupt_buffer, &out_buffer) == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+        REQUIRE(out_buffer.empty());
+
+        // chunks which are smaller than their own data can't be read, a size of 0 would decode the chunk twice
+        header.m_RequiredUnpackBufferSize += 1;
+        header.m_TotalUnpackedSize *= 2;
+        header.m_NumChunks = 2;
+        std::memcpy(corrupt_buffer.data(), &header, sizeof(AafHeader));
+
+        AafChunk chunk;
+        std::memcpy(&chunk, corrupt_buffer.data() + sizeof(AafHeader), sizeof(AafChunk));
+        for (const uint32_t chunk_size : {0u, static_cast<uint32_t>(sizeof(AafChunk) + chunk.m_CompressedSize - 1)}) {
+            AafChunk short_chunk    = chunk;
+            short_chunk.m_ChunkSize = chunk_size;
+            std::memcpy(corrupt_buffer.data() + sizeof(AafHeader), &short_chunk, sizeof(AafChunk));
+            REQUIRE(Decompress(corrupt_buffer, &out_buffer) == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+            REQUIRE(out_buffer.empty());
+        }
+
+        // chunks which don't move past their own data would be read over and over
+        FileBuffer looping_buffer = buffer;
+        AafHeader  looping_header;
+        AafChunk   looping_chunk;
+        std::memcpy(&looping_header, looping_buffer.data(), sizeof(AafHeader));
+        std::memcpy(&looping_chunk, looping_buffer.data() + sizeof(AafHeader), sizeof(AafChunk));
+        looping_header.m_NumChunks = 0xFFFFFFFF;
+        looping_chunk.m_ChunkSize  = 0;
+        std::memcpy(looping_buffer.data(), &looping_header, sizeof(AafHeader));
+        std::memcpy(looping_buffer.data() + sizeof(AafHeader), &looping_chunk, sizeof(AafChunk));
+
+        std::vector<ChunkRange> chunks;
+        REQUIRE(BuildChunkIndex(looping_buffer.data(), looping_buffer.size(), &chunks)
+                == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+        REQUIRE(Decompress(looping_buffer, &out_buffer) == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+        REQUIRE(out_buffer.empty());
     }
 
     SECTION("decompression has valid output buffer")
@@ -200,6 +1103,167 @@ TEST_CASE("Avalanche Archive Format", "[AvaFormatLib][AAF]")
             REQUIRE(FilesAreTheSame(recompressed_buffer, buffer));
         }
     }
+
+    SECTION("can compress and decompress multiple chunks")
+    {
+        FileBuffer large_buffer((AAF_MAX_CHUNK_DATA_SIZE * 2) + 1000);
+        for (size_t i = 0; i < large_buffer.size(); ++i) {
+            large_buffer[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12));
+        }
+
+        FileBuffer compressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Compress(large_buffer, &compressed_buffer)));
+
+        AafHeader header;
+        std::memcpy(&header, compressed_buffer.data(), sizeof(AafHeader));
+        REQUIRE(header.m_NumChunks == 3);
+        REQUIRE(header.m_TotalUnpackedSize == large_buffer.size());
+
+        FileBuffer decompressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(compressed_buffer, &decompressed_buffer)));
+        REQUIRE(FilesAreTheSame(decompressed_buffer, large_buffer));
+
+        // range across the first chunk boundary
+        FileBuffer range;
+        REQUIRE(AVA_FL_SUCCEEDED(DecompressRange(compressed_buffer.data(), compressed_buffer.size(),
+                                                 AAF_MAX_CHUNK_DATA_SIZE - 100, 200, &range)));
+        REQUIRE(std::equal(range.begin(), range.end(), large_buffer.begin() + (AAF_MAX_CHUNK_DATA_SIZE - 100)));
+
+        std::istringstream stream(std::string((char*)compressed_buffer.data(), compressed_buffer.size()));
+
+        FileBuffer streamed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(stream, [&](const uint8_t* data, const uint32_t size) {
+            REQUIRE(size <= header.m_RequiredUnpackBufferSize);
+            streamed_buffer.insert(streamed_buffer.end(), data, data + size);
+            return ava::Result::E_OK;
+        })));
+        REQUIRE(FilesAreTheSame(streamed_buffer, large_buffer));
+    }
+
+    SECTION("can compress with custom options")
+    {
+        FileBuffer decompressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(buffer, &decompressed_buffer)));
+
+        // default options give the same output as the game files
+        FileBuffer compressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Compress(decompressed_buffer, CompressOptions{}, &compressed_buffer)));
+        REQUIRE(FilesAreTheSame(compressed_buffer, buffer));
+
+        for (const CompressOptions& options : {AAF_COMPRESS_FAST, AAF_COMPRESS_SHIPPING}) {
+            compressed_buffer.clear();
+            REQUIRE(AVA_FL_SUCCEEDED(Compress(decompressed_buffer, options, &compressed_buffer)));
+
+            AafHeader header;
+            std::memcpy(&header, compressed_buffer.data(), sizeof(AafHeader));
+            REQUIRE(header.m_NumChunks == (1 + (decompressed_buffer.size() / options.m_ChunkSize)));
+
+            FileBuffer roundtrip_buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(Decompress(compressed_buffer, &roundtrip_buffer)));
+            REQUIRE(FilesAreTheSame(roundtrip_buffer, decompressed_buffer));
+        }
+
+        CompressOptions options;
+        options.m_ChunkSize = 0;
+        REQUIRE(Compress(decompressed_buffer, options, &compressed_buffer) == ava::Result::E_INVALID_ARGUMENT);
+        options.m_ChunkSize = (AAF_MAX_CHUNK_DATA_SIZE + 1);
+        REQUIRE(Compress(decompressed_buffer, options, &compressed_buffer) == ava::Result::E_INVALID_ARGUMENT);
+    }
+
+    SECTION("can decompress a range")
+    {
+        FileBuffer decompressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(buffer, &decompressed_buffer)));
+
+        std::vector<ChunkRange> chunks;
+        uint64_t                total_size = 0;
+        REQUIRE(AVA_FL_SUCCEEDED(BuildChunkIndex(buffer.data(), buffer.size(), &chunks, &total_size)));
+        REQUIRE(chunks.size() == 1);
+        REQUIRE(total_size == decompressed_buffer.size());
+
+        FileBuffer range;
+        REQUIRE(AVA_FL_SUCCEEDED(DecompressRange(buffer.data(), buffer.size(), chunks, 0, 16, &range)));
+        REQUIRE(std::equal(range.begin(), range.end(), decompressed_buffer.begin()));
+
+        REQUIRE(AVA_FL_SUCCEEDED(DecompressRange(buffer.data(), buffer.size(), 100, 4096, &range)));
+        REQUIRE(range.size() == 4096);
+        REQUIRE(std::equal(range.begin(), range.end(), decompressed_buffer.begin() + 100));
+
+        REQUIRE(DecompressRange(buffer.data(), buffer.size(), chunks, total_size - 8, 16, &range)
+                == ava::Result::E_INVALID_ARGUMENT);
+    }
+
+    SECTION("can decompress from a stream")
+    {
+        FileBuffer decompressed_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(buffer, &decompressed_buffer)));
+
+        std::istringstream stream(std::string((char*)buffer.data(), buffer.size()));
+
+        FileBuffer streamed_buffer;
+        uint32_t   num_chunks = 0;
+        REQUIRE(AVA_FL_SUCCEEDED(Decompress(stream, [&](const uint8_t* data, const uint32_t size) {
+            streamed_buffer.insert(streamed_buffer.end(), data, data + size);
+            ++num_chunks;
+            return ava::Result::E_OK;
+        })));
+        REQUIRE(num_chunks == 1);
+        REQUIRE(FilesAreTheSame(streamed_buffer, decompressed_buffer));
+
+        // sink failures stop the decompression
+        stream.clear();
+        stream.seekg(0);
+        REQUIRE(Decompress(stream, [](const uint8_t*, const uint32_t) { return ava::Result::E_FAILED_TO_OPEN_FILE; })
+                == ava::Result::E_FAILED_TO_OPEN_FILE);
+
+        std::istringstream truncated_stream(std::string((char*)buffer.data(), buffer.size() / 2));
+        REQUIRE(Decompress(truncated_stream, [](const uint8_t*, const uint32_t) { return ava::Result::E_OK; })
+                == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+
+        // chunks can't be bigger than the header's unpack buffer size
+        FileBuffer oversized_buffer = buffer;
+        AafChunk   chunk;
+        std::memcpy(&chunk, oversized_buffer.data() + sizeof(AafHeader), sizeof(AafChunk));
+        chunk.m_DecompressedSize += 1;
+        std::memcpy(oversized_buffer.data() + sizeof(AafHeader), &chunk, sizeof(AafChunk));
+
+        std::istringstream oversized_stream(std::string((char*)oversized_buffer.data(), oversized_buffer.size()));
+        REQUIRE(Decompress(oversized_stream, [](const uint8_t*, const uint32_t) { return ava::Result::E_OK; })
+                == ava::Result::E_AAF_CHUNK_OUT_OF_BOUNDS);
+    }
+}
+
+TEST_CASE("Avalanche Archive Format Compression Benchmark", "[AvaFormatLib][AAF][!benchmark]")
+{
+    using namespace ava::AvalancheArchiveFormat;
+
+    FileBuffer buffer, decompressed_buffer;
+    ReadTestFile("grapplinghookwire.ee", &buffer);
+    REQUIRE(AVA_FL_SUCCEEDED(Decompress(buffer, &decompressed_buffer)));
+
+    static constexpr uint32_t NUM_ITERATIONS = 10;
+
+    const std::pair<const char*, CompressOptions> presets[] = {
+        {"Default", CompressOptions{}},
+        {"Fast", AAF_COMPRESS_FAST},
+        {"Shipping", AAF_COMPRESS_SHIPPING},
+    };
+
+    for (const auto& [name, options] : presets) {
+        FileBuffer compressed_buffer;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < NUM_ITERATIONS; ++i) {
+            compressed_buffer.clear();
+            REQUIRE(AVA_FL_SUCCEEDED(Compress(decompressed_buffer, options, &compressed_buffer)));
+        }
+
+        const double seconds   = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double megabytes = ((double)decompressed_buffer.size() * NUM_ITERATIONS) / (1024.0 * 1024.0);
+        const double ratio     = ((double)compressed_buffer.size() / (double)decompressed_buffer.size());
+        std::printf("%-10s %8.2f MB/s  ratio %.3f (%zu -> %zu bytes)\n", name, (megabytes / seconds), ratio,
+                    decompressed_buffer.size(), compressed_buffer.size());
+    }
 }
 
 TEST_CASE("Stream Archive", "[AvaFormatLib][SARC]")
@@ -236,13 +1300,87 @@ TEST_CASE("Stream Archive", "[AvaFormatLib][SARC]")
             REQUIRE((out_buffer[0] == 'R' && out_buffer[1] == 'T' && out_buffer[2] == 'P' && out_buffer[3] == 'C'));
         }
 
+        SECTION("can read entry views")
+        {
+            const EntryIndex    index(entries);
+            const ArchiveEntry* entry = index.Find("editor/entities/dlc/wingsuit_skins/wgst002_skin_flame.epe");
+            REQUIRE(entry != nullptr);
+
+            const uint8_t* data = nullptr;
+            uint32_t       size = 0;
+            REQUIRE(AVA_FL_SUCCEEDED(ReadEntry(buffer.data(), buffer.size(), *entry, &data, &size)));
+            REQUIRE(data == (buffer.data() + entry->m_Offset));
+            REQUIRE(size == entry->m_Size);
+
+            // nested formats can be parsed straight from the archive buffer
+            ava::RuntimePropertyContainer::Container root_container;
+            REQUIRE(AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(data, size, &root_container)));
+            REQUIRE(root_container.valid());
+
+            ArchiveEntry out_of_bounds_entry = *entry;
+            out_of_bounds_entry.m_Size       = static_cast<uint32_t>(buffer.size());
+            REQUIRE(ReadEntry(buffer.data(), buffer.size(), out_of_bounds_entry, &data, &size)
+                    == ava::Result::E_SARC_ENTRY_OUT_OF_BOUNDS);
+        }
+
+        SECTION("can read entries from an entry index")
+        {
+            const EntryIndex index(entries);
+            REQUIRE(index.Find("models/jc_aero/wingsuit/wingsuit_dlc_body.lod") == &index.GetEntries().at(10));
+            REQUIRE(index.Find(ava::hashlittle("missing.bin")) == nullptr);
+
+            std::vector<uint8_t> out_buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(
+                index.ReadEntry(buffer, "editor/entities/dlc/wingsuit_skins/wgst002_skin_flame.epe", &out_buffer)));
+            REQUIRE((out_buffer[0] == 'R' && out_buffer[1] == 'T' && out_buffer[2] == 'P' && out_buffer[3] == 'C'));
+            REQUIRE(index.ReadEntry(buffer, "missing.bin", &out_buffer) == ava::Result::E_SARC_UNKNOWN_ENTRY);
+        }
+
+        SECTION("can parse entry views")
+        {
+            std::vector<ArchiveEntryView> views;
+            REQUIRE(AVA_FL_SUCCEEDED(Parse(buffer.data(), buffer.size(), &views)));
+            REQUIRE(views.size() == entries.size());
+            for (size_t i = 0; i < views.size(); ++i) {
+                REQUIRE(views[i].m_Filename == entries[i].m_Filename);
+                REQUIRE(views[i].m_NameHash == entries[i].m_NameHash);
+                REQUIRE(views[i].m_Offset == entries[i].m_Offset);
+                REQUIRE(views[i].m_Size == entries[i].m_Size);
+            }
+
+            REQUIRE(Parse(buffer.data(), sizeof(SarcHeader), &views) == ava::Result::E_SARC_ENTRY_OUT_OF_BOUNDS);
+        }
+
         SECTION("can write entries")
         {
             FileBuffer world_buffer;
             ReadTestFile("world.bin", &world_buffer);
 
+            // entries which are only listed in the TOC keep their offset
+            entries.push_back(ArchiveEntry{"toc_only.bin", ava::hashlittle("toc_only.bin"), 0xFFFFFFFF, 0x10});
+
             REQUIRE(AVA_FL_SUCCEEDED(WriteEntry(&buffer, &entries, "world.bin", world_buffer)));
             REQUIRE(entries.back().m_Filename == "world.bin");
+
+            std::vector<ArchiveEntry> written_entries;
+            REQUIRE(AVA_FL_SUCCEEDED(Parse(buffer, &written_entries)));
+            REQUIRE(written_entries.size() == entries.size());
+            REQUIRE(written_entries[written_entries.size() - 2].m_Filename == "toc_only.bin");
+            REQUIRE(written_entries[written_entries.size() - 2].m_Offset == 0xFFFFFFFF);
+            REQUIRE(entries[entries.size() - 2].m_Offset == 0xFFFFFFFF);
+        }
+
+        SECTION("builder output matches the original file")
+        {
+            ArchiveBuilder builder(2);
+            for (const auto& entry : entries) {
+                const auto start = buffer.begin() + entry.m_Offset;
+                REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry(entry.m_Filename, FileBuffer(start, start + entry.m_Size))));
+            }
+
+            FileBuffer out_buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(builder.Write(&out_buffer)));
+            REQUIRE(out_buffer == buffer);
         }
     }
 
@@ -261,6 +1399,16 @@ TEST_CASE("Stream Archive", "[AvaFormatLib][SARC]")
                     == "editor/entities/spawners/combatant_spawnrules/spawn_modules/paratrooper_drop.epe");
         }
 
+        SECTION("can parse entry views")
+        {
+            std::vector<ArchiveEntryView> views;
+            REQUIRE(AVA_FL_SUCCEEDED(Parse(buffer.data(), buffer.size(), &views)));
+            REQUIRE(views.size() == entries.size());
+            REQUIRE(views.at(2).m_Filename
+                    == "editor/entities/spawners/combatant_spawnrules/spawn_modules/paratrooper_drop.epe");
+            REQUIRE(views.at(2).m_NameHash == ava::hashlittle(std::string(views.at(2).m_Filename).c_str()));
+        }
+
         SECTION("can read entries")
         {
             std::vector<uint8_t> out_buffer;
@@ -272,19 +1420,83 @@ TEST_CASE("Stream Archive", "[AvaFormatLib][SARC]")
             REQUIRE_FALSE(out_buffer.empty());
         }
 
-#if 0
-		SECTION("can write entries")
+        SECTION("can write entries")
         {
             FileBuffer world_buffer;
             ReadTestFile("world.bin", &world_buffer);
 
-            REQUIRE_NOTHROW(WriteEntry(buffer, &entries, "world.bin", world_buffer));
+            REQUIRE(AVA_FL_SUCCEEDED(WriteEntry(&buffer, &entries, "world.bin", world_buffer)));
             REQUIRE(entries.back().m_Filename == "world.bin");
+
+            std::vector<uint8_t> out_buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(ReadEntry(buffer, entries, "world.bin", &out_buffer)));
+            REQUIRE(FilesAreTheSame(out_buffer, world_buffer));
+        }
+
+        SECTION("builder output matches the original file")
+        {
+            ArchiveBuilder builder(3);
+            for (const auto& entry : entries) {
+                if (entry.m_Offset == 0) {
+                    REQUIRE(AVA_FL_SUCCEEDED(builder.AddPatchedEntry(entry.m_Filename, entry.m_Size)));
+                    continue;
+                }
+
+                const auto start = buffer.begin() + entry.m_Offset;
+                REQUIRE(AVA_FL_SUCCEEDED(builder.AddEntry(entry.m_Filename, FileBuffer(start, start + entry.m_Size))));
+            }
+
+            FileBuffer out_buffer;
+            REQUIRE(AVA_FL_SUCCEEDED(builder.Write(&out_buffer)));
+            REQUIRE(out_buffer == buffer);
+
+            // streaming the archive gives the same result
+            std::ostringstream stream;
+            REQUIRE(AVA_FL_SUCCEEDED(builder.Write(stream)));
+            REQUIRE(stream.str() == std::string(buffer.begin(), buffer.end()));
         }
-#endif
     }
 }
 
+TEST_CASE("Stream Archive Parse Benchmark", "[AvaFormatLib][SARC][!benchmark]")
+{
+    using namespace ava::StreamArchive;
+
+    // synthetic v2 SARC with 20k entry headers (entry buffers aren't needed to parse)
+    static constexpr uint32_t NUM_ENTRIES = 20000;
+
+    FileBuffer                   buffer;
+    ava::utils::ByteVectorStream buf(&buffer);
+    buf.write(SarcHeader{4, SARC_MAGIC, 2, 0});
+    for (uint32_t i = 0; i < NUM_ENTRIES; ++i) {
+        const std::string filename = "editor/entities/benchmark/entry_" + std::to_string(i) + ".epe";
+
+        uint32_t       padding = 0;
+        const uint32_t length  = ava::math::aligned_string_len(filename, sizeof(uint32_t), &padding);
+        buf.write(length);
+        buf.write(filename.c_str(), filename.length());
+        buf.write((char*)&SARC_ENTRY_PADDING_BYTE, sizeof(uint8_t), padding);
+        buf.write(i * 0x10);
+        buf.write(uint32_t(0x10));
+    }
+
+    reinterpret_cast<SarcHeader*>(buffer.data())->m_Size = static_cast<uint32_t>(buffer.size() - sizeof(SarcHeader));
+
+    BENCHMARK("Parse (ArchiveEntry)")
+    {
+        std::vector<ArchiveEntry> entries;
+        Parse(buffer, &entries);
+        return entries.size();
+    };
+
+    BENCHMARK("Parse (ArchiveEntryView)")
+    {
+        std::vector<ArchiveEntryView> entries;
+        Parse(buffer.data(), buffer.size(), &entries);
+        return entries.size();
+    };
+}
+
 TEST_CASE("Stream Archive TOC", "[AvaFormatLib][TOC]")
 {
     using namespace ava::StreamArchive;
@@ -306,6 +1518,34 @@ TEST_CASE("Stream Archive TOC", "[AvaFormatLib][TOC]")
         REQUIRE_FALSE(entries.empty());
         REQUIRE(entries[9].m_Filename == "effects/textures/t_smoke_blast_alpha_dif.ddsc");
     }
+
+    SECTION("can merge TOC layers")
+    {
+        std::vector<ArchiveEntry> entries;
+        REQUIRE(AVA_FL_SUCCEEDED(ParseTOC(buffer, &entries)));
+
+        // patch layer which moves one entry and adds a new one
+        std::vector<ArchiveEntry> patch_entries{entries[9], ArchiveEntry{"new.bin", 0, 0x10, 0x20}};
+        patch_entries[0].m_Size += 0x10;
+
+        FileBuffer patch_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(WriteTOC(&patch_buffer, patch_entries)));
+
+        const size_t num_entries   = entries.size();
+        uint32_t     total_added   = 0;
+        uint32_t     total_patched = 0;
+        const std::vector<const FileBuffer*> missing_layers{&buffer, nullptr};
+        REQUIRE(ParseTOC(missing_layers, &entries, &total_added, &total_patched) == ava::Result::E_INVALID_ARGUMENT);
+
+        const std::vector<const FileBuffer*> layers{&buffer, &patch_buffer};
+        REQUIRE(AVA_FL_SUCCEEDED(ParseTOC(layers, &entries, &total_added, &total_patched)));
+        REQUIRE(total_added == 1);
+        REQUIRE(total_patched == 1);
+        REQUIRE(entries.size() == (num_entries + 1));
+        REQUIRE(entries[9].m_Size == patch_entries[0].m_Size);
+        REQUIRE(entries.back().m_Filename == "new.bin");
+        REQUIRE(entries.back().m_NameHash == ava::hashlittle("new.bin"));
+    }
 }
 
 TEST_CASE("Resource Bundle", "[AvaFormatLib][ResourceBundle]")
@@ -476,6 +1716,41 @@ TEST_CASE("Avalanche Data Format", "[AvaFormatLib][ADF]")
 
         std::free(weapon_tweaks);
     }
+
+    SECTION("can read root instance from memory")
+    {
+        AdfHeader header{};
+        REQUIRE(AVA_FL_SUCCEEDED(ParseHeader(buffer.data(), buffer.size(), &header)));
+        REQUIRE(header.m_InstanceCount == 1);
+
+        ADF adf(buffer.data(), buffer.size());
+
+        WeaponTweaks* weapon_tweaks = nullptr;
+        REQUIRE(adf.ReadInstance(0xd9066df1, 0x8dfb5000, (void**)&weapon_tweaks));
+        REQUIRE(weapon_tweaks != nullptr);
+        REQUIRE(weapon_tweaks->Sniper.InitialRandomAimDistance == 1.5f);
+
+        std::free(weapon_tweaks);
+    }
+
+    SECTION("can find built in and loaded types")
+    {
+        ADF adf(buffer);
+
+        for (const AdfType* type : adf.GetTypes(false)) {
+            REQUIRE(adf.FindType(type->m_TypeHash) == type);
+        }
+
+        REQUIRE(adf.FindType(0xDEFE88ED) != nullptr);
+        REQUIRE(adf.FindType(0x8dfb5000) != nullptr);
+        REQUIRE(adf.FindType(0x8dfb5000)->m_Type == ava::ADF_TYPE_STRUCT);
+        REQUIRE(adf.FindType(0x12345678) == nullptr);
+
+        // adding the same types again doesn't duplicate them
+        const size_t num_types = adf.GetTypes(false).size();
+        adf.AddTypes(buffer);
+        REQUIRE(adf.GetTypes(false).size() == num_types);
+    }
 }
 
 TEST_CASE("Render Block Model", "[AvaFormatLib][RBMDL]")
@@ -596,6 +1871,14 @@ TEST_CASE("Avalanche Texture", "[AvaFormatLib][AVTX]")
         REQUIRE(entry.m_Width == 300);
         REQUIRE(entry.m_Height == 300);
         REQUIRE_FALSE(out_buffer.empty());
+
+        // textures can be read straight from memory too
+        TextureEntry         memory_entry{};
+        std::vector<uint8_t> memory_buffer;
+        REQUIRE(AVA_FL_SUCCEEDED(ReadBestEntry(buffer.data(), buffer.size(), &memory_entry, &memory_buffer)));
+        REQUIRE(memory_entry.m_Width == entry.m_Width);
+        REQUIRE(memory_entry.m_Height == entry.m_Height);
+        REQUIRE(FilesAreTheSame(memory_buffer, out_buffer));
     }
 
 #if 0